@@ -0,0 +1,360 @@
+#include <JuceHeader.h>
+
+#include "../../Source/Model/Synthesizer/OscillatorKernel.h"
+#include "../../Source/Model/Synthesizer/SineBankKernel.h"
+#include "../../Source/Model/Synthesizer/WavetableGenerator.h"
+#include "../../Source/Model/Effects/Equalizer/BiquadKernel.h"
+#include "../../Source/PluginProcessor.h"
+
+//Times the hot paths of the synth in isolation, and how long an instance takes to create, so a change to one of them can be measured without a host. Every case is repeated a few times and the fastest run is reported, the others only suffered from the scheduler
+namespace Benchmarks
+{
+    using namespace Processor::Synthesizer;
+
+    constexpr double SAMPLE_RATE = 48000.0;
+    constexpr int BLOCK_SIZE = 512;
+    constexpr int RUNS = 5;
+    constexpr int EQ_BANDS = Processor::Effects::Equalizer::NUM_BANDS;
+    constexpr int ALIVE_INSTANCES = 40;                     //About as many instances as a large project keeps open
+
+    float sink = 0.f;                                       //Every result is added here and printed, so the compiler can't drop the work
+
+    /// @return The fastest of the runs, in seconds per call of the body
+    template <typename Function>
+    double measure(int callsPerRun, Function&& body)
+    {
+        double fastest = std::numeric_limits<double>::max();
+        for(int run = 0; run < RUNS; run++)
+        {
+            const auto start = juce::Time::getHighResolutionTicks();
+            for(int call = 0; call < callsPerRun; call++)
+            {
+                body();
+            }
+            const auto elapsed = juce::Time::getHighResolutionTicks() - start;
+            fastest = juce::jmin(fastest, juce::Time::highResolutionTicksToSeconds(elapsed) / callsPerRun);
+        }
+        return fastest;
+    }
+
+    /// @brief A sawtooth spectrum with pseudo random phases, every partial is in use
+    void makeSpectrum(std::array<float, HARMONIC_N>& gains, std::array<float, HARMONIC_N>& phases)
+    {
+        juce::Random random(42);
+        for(int i = 0; i < HARMONIC_N; i++)
+        {
+            gains[(size_t)i] = 1.f / (float)( i + 1 );
+            phases[(size_t)i] = random.nextFloat();
+        }
+    }
+
+    /// @brief Copies a generated level and closes it with its first point, the way a WavetableSet stores it
+    std::vector<float> makeTableSamples(const WavetableGenerator& generator, int level)
+    {
+        const int size = WavetableGenerator::getLevelSize(level);
+        std::vector<float> samples(generator.getLevel(level), generator.getLevel(level) + size);
+        samples.push_back(samples.front());
+        return samples;
+    }
+
+    /// @brief Sets up a voice at 220 Hz with the given number of unison oscillators
+    VoiceAngleData makeVoice(int activeLanes)
+    {
+        VoiceAngleData data;
+        data.activeLanes = activeLanes;
+        data.frequency = 220.f;
+
+        for(int lane = 0; lane < activeLanes; lane++)
+        {
+            const double detune = 1.0 + 0.002 * ( lane + 1 ) / 2 * ( lane % 2 == 0 ? -1 : 1 );
+            data.phaseIncrement[lane] = VoiceAngleData::cyclesToPhase(220.0 * detune / SAMPLE_RATE);
+            data.gain[lane] = 1.f / (float)activeLanes;
+            data.phase[1][lane] = VoiceAngleData::cyclesToPhase(0.25 * lane);
+        }
+        return data;
+    }
+
+    void benchmarkOscillators(int blocks)
+    {
+        std::array<float, HARMONIC_N> gains, phases;
+        makeSpectrum(gains, phases);
+
+        WavetableGenerator generator;
+        generator.update(gains, phases, ALL_LEVELS);
+
+        std::printf("renderOscillators, %d sample blocks, stereo\n", BLOCK_SIZE);
+        std::printf("  %-8s %-8s %14s %16s\n", "level", "lanes", "ns / sample", "voices at 48k");
+
+        juce::AudioBuffer<float> buffer(2, BLOCK_SIZE);
+
+        for(int level : { 0, LOOKUP_SIZE / 2 })
+        {
+            const auto samples = makeTableSamples(generator, level);
+            const Wavetable table(samples.data(), (int)samples.size() - 1);
+
+            for(int lanes : { 1, 3, 7, OSCILLATOR_LANES })
+            {
+                auto voice = makeVoice(lanes);
+                const double seconds = measure(blocks, [&]
+                {
+                    buffer.clear();
+                    renderOscillators(voice, table, buffer.getArrayOfWritePointers(), BLOCK_SIZE);
+                    sink += buffer.getSample(0, BLOCK_SIZE - 1);
+                });
+
+                const double perSample = seconds / BLOCK_SIZE;
+                std::printf("  %-8d %-8d %14.2f %16.0f\n", level, lanes, perSample * 1.0e9, 1.0 / ( perSample * SAMPLE_RATE ));
+            }
+        }
+        std::printf("\n");
+    }
+
+    /// @brief The first count harmonics of a sawtooth with the phases of makeSpectrum, once for each engine
+    PartialSpectrum makePartials(int count, std::array<float, HARMONIC_N>& gains, std::array<float, HARMONIC_N>& phases)
+    {
+        makeSpectrum(gains, phases);
+        std::fill(gains.begin() + count, gains.end(), 0.f);
+
+        PartialSpectrum spectrum;
+        spectrum.count = count;
+        for(int i = 0; i < count; i++)
+        {
+            const double phase = juce::MathConstants<double>::twoPi * phases[(size_t)i];
+            spectrum.harmonics[(size_t)i] = i + 1;
+            spectrum.gains[(size_t)i] = gains[(size_t)i];
+            spectrum.phaseSine[(size_t)i] = std::sin(phase);
+            spectrum.phaseCosine[(size_t)i] = std::cos(phase);
+        }
+        return spectrum;
+    }
+
+    /// @brief Renders the same voice with the sine bank and the wavetable, and prints which one chooseOscillatorEngine would pick, so its cost model can be checked against the timings
+    template <int MaxPartials>
+    void benchmarkSineBankAgainstWavetable(int blocks, int partials)
+    {
+        std::array<float, HARMONIC_N> gains, phases;
+        const auto spectrum = makePartials(partials, gains, phases);
+
+        WavetableGenerator generator;
+        generator.update(gains, phases, 1u);
+        const auto samples = makeTableSamples(generator, 0);
+        const Wavetable table(samples.data(), (int)samples.size() - 1);
+
+        juce::AudioBuffer<float> buffer(2, BLOCK_SIZE);
+        auto bank = std::make_unique<SineBankData<MaxPartials>>();
+
+        for(int lanes : { 1, 3, 7, OSCILLATOR_LANES })
+        {
+            auto voice = makeVoice(lanes);
+            const double wavetable = measure(blocks, [&]
+            {
+                buffer.clear();
+                renderOscillators(voice, table, buffer.getArrayOfWritePointers(), BLOCK_SIZE);
+                sink += buffer.getSample(0, BLOCK_SIZE - 1);
+            });
+
+            voice = makeVoice(lanes);
+            seedSineBank(*bank, voice, spectrum, 2);
+            setSineBankAmplitudes(*bank, spectrum.gains.data(), spectrum.count);
+            const double sineBank = measure(blocks, [&]
+            {
+                buffer.clear();
+                renderSineBank(*bank, voice, buffer.getArrayOfWritePointers(), BLOCK_SIZE, 2);
+                sink += buffer.getSample(0, BLOCK_SIZE - 1);
+            });
+
+            auto engineName = [](OscillatorEngine engine) { return engine == OscillatorEngine::sineBank ? "sine bank" : "wavetable"; };
+            std::printf("  %-8d %-8d %12.2f %12.2f %12s %12s\n", partials, lanes, wavetable / BLOCK_SIZE * 1.0e9, sineBank / BLOCK_SIZE * 1.0e9,
+                        engineName(chooseOscillatorEngine(partials, lanes, 1)), engineName(chooseOscillatorEngine(partials, lanes, 2 * TABLE_CACHED_VOICES)));
+        }
+    }
+
+    void benchmarkEngines(int blocks)
+    {
+        std::printf("Sine bank against wavetable, ns / sample of one voice, %d sample blocks, stereo\n", BLOCK_SIZE);
+        std::printf("  %-8s %-8s %12s %12s %12s %12s\n", "partials", "lanes", "wavetable", "sine bank", "pick, 1", "pick, many");
+
+        for(int partials : { 2, 4, 8, SPARSE_MAX_PARTIALS })
+        {
+            benchmarkSineBankAgainstWavetable<SPARSE_MAX_PARTIALS>(blocks, partials);
+        }
+
+        //The partial bank is the same kernel over every harmonic, used when the partials have their own envelopes
+        benchmarkSineBankAgainstWavetable<HARMONIC_N>(juce::jmax(1, blocks / 16), HARMONIC_N);
+        std::printf("\n");
+    }
+
+    /// @brief Runs the ten peaking bands of the equalizer through the cascade, and through twenty juce IIR filters, one per band and channel, the way the equalizer ran them before.
+    /// The bands sit at the equalizer's frequencies with its gain-proportional Q
+    void benchmarkEqualizerCase(int blocks, const char* name, const std::array<float, EQ_BANDS>& bandGains)
+    {
+        using namespace Processor::Effects::Equalizer;
+
+        juce::AudioBuffer<float> input(2, BLOCK_SIZE), buffer(2, BLOCK_SIZE);
+        juce::Random random(42);
+        for(int channel = 0; channel < 2; channel++)
+            for(int i = 0; i < BLOCK_SIZE; i++)
+                input.getArrayOfWritePointers()[channel][i] = random.nextFloat() * 2.f - 1.f;
+
+        //Every call filters the same noise, so repeated boosts can't grow into infinities
+        auto copyInput = [&]
+        {
+            for(int channel = 0; channel < 2; channel++)
+                std::copy(input.getArrayOfWritePointers()[channel], input.getArrayOfWritePointers()[channel] + BLOCK_SIZE, buffer.getArrayOfWritePointers()[channel]);
+        };
+
+        std::array<std::array<juce::dsp::IIR::Filter<float>, EQ_BANDS>, 2> filters;
+        BiquadCascade<EQ_BANDS> cascade;
+        for(int band = 0; band < EQ_BANDS; band++)
+        {
+            const float frequency = 31.25f * (float)( 1 << band );
+            const float q = bandGains[(size_t)band] == 0.f ? 1.f : 0.25f * std::abs(bandGains[(size_t)band]);
+            const float gainFactor = juce::Decibels::decibelsToGain(bandGains[(size_t)band]);
+
+            for(auto& channel : filters)
+            {
+                channel[(size_t)band].prepare({ SAMPLE_RATE, (juce::uint32)BLOCK_SIZE, 1 });
+                channel[(size_t)band].coefficients = juce::dsp::IIR::Coefficients<float>::makePeakFilter(SAMPLE_RATE, frequency, q, gainFactor);
+            }
+
+            if( bandGains[(size_t)band] != 0.f )
+                cascade.setSection(band, BiquadCoefficients::makePeak(SAMPLE_RATE, frequency, q, gainFactor));
+        }
+
+        const double filterSeconds = measure(blocks, [&]
+        {
+            copyInput();
+            juce::dsp::AudioBlock<float> block(buffer);
+            for(int channel = 0; channel < 2; channel++)
+            {
+                auto singleBlock = block.getSingleChannelBlock((size_t)channel);
+                juce::dsp::ProcessContextReplacing<float> context(singleBlock);
+                for(auto& filter : filters[(size_t)channel])
+                    filter.process(context);
+            }
+            sink += buffer.getSample(1, BLOCK_SIZE - 1);
+        });
+
+        const double cascadeSeconds = measure(blocks, [&]
+        {
+            copyInput();
+            cascade.process(buffer.getArrayOfWritePointers()[0], buffer.getArrayOfWritePointers()[1], BLOCK_SIZE);
+            sink += buffer.getSample(1, BLOCK_SIZE - 1);
+        });
+
+        std::printf("  %-22s %14.2f %14.2f %10.2fx\n", name, filterSeconds / BLOCK_SIZE * 1.0e9, cascadeSeconds / BLOCK_SIZE * 1.0e9, filterSeconds / cascadeSeconds);
+    }
+
+    void benchmarkEqualizer(int blocks)
+    {
+        std::printf("Equalizer, ns / stereo sample, %d sample blocks\n", BLOCK_SIZE);
+        std::printf("  %-22s %14s %14s %11s\n", "bands", "IIR filters", "cascade", "speedup");
+
+        benchmarkEqualizerCase(blocks, "10 bands on", { 3.f, -6.f, 2.f, 4.f, -3.f, 5.f, -2.f, 1.f, -4.f, 6.f });
+        benchmarkEqualizerCase(blocks, "3 bands on, 7 at 0 dB", { 0.f, 0.f, 4.f, 0.f, 0.f, -3.f, 0.f, 0.f, 6.f, 0.f });
+        benchmarkEqualizerCase(blocks, "every band at 0 dB", {});
+        std::printf("\n");
+    }
+
+    /// @brief Creates and destroys whole plugin instances, the way a host does while it scans plugins or loads a project.
+    /// Run first, so the first instance also builds everything that is shared by the instances of a process
+    void benchmarkInstantiation(int instances)
+    {
+        const juce::ScopedJuceInitialiser_GUI messageManager;   //The processor starts timers, which need a message thread
+
+        std::printf("VST_SynthAudioProcessor, ms / instance, created and destroyed
+");
+
+        const auto start = juce::Time::getHighResolutionTicks();
+        {
+            VST_SynthAudioProcessor processor;
+            sink += (float)processor.getTotalNumOutputChannels();
+        }
+        const double first = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+
+        const double single = measure(instances, [&]
+        {
+            VST_SynthAudioProcessor processor;
+            sink += (float)processor.getTotalNumOutputChannels();
+        });
+
+        //Every instance is still alive while the next one is created, like the instances of one project
+        const double alive = measure(juce::jmax(1, instances / ALIVE_INSTANCES), [&]
+        {
+            std::vector<std::unique_ptr<VST_SynthAudioProcessor>> processors;
+            for(int i = 0; i < ALIVE_INSTANCES; i++)
+            {
+                processors.push_back(std::make_unique<VST_SynthAudioProcessor>());
+                sink += (float)processors.back()->getTotalNumOutputChannels();
+            }
+        }) / ALIVE_INSTANCES;
+
+        std::printf("  %-36s %10.2f ms\n", "first instance of the process", first * 1.0e3);
+        std::printf("  %-36s %10.2f ms\n", "one at a time", single * 1.0e3);
+        std::printf("  %-36s %10.2f ms\n", ( juce::String(ALIVE_INSTANCES) + " alive at once" ).toRawUTF8(), alive * 1.0e3);
+        std::printf("\n");
+    }
+
+    void benchmarkWavetableRebuild(int rebuilds)
+    {
+        std::array<float, HARMONIC_N> gains, phases;
+        makeSpectrum(gains, phases);
+
+        WavetableGenerator generator;
+        generator.update(gains, phases, ALL_LEVELS);
+
+        std::printf("WavetableGenerator::update, %d levels\n", LOOKUP_SIZE);
+
+        //Changing every partial forces the inverse FFTs of each wanted level
+        float offset = 0.f;
+        const double fullAll = measure(rebuilds, [&]
+        {
+            offset = 0.5f - offset;
+            for(auto& phase : phases)
+                phase = std::fmod(phase + offset, 1.f);
+
+            sink += generator.update(gains, phases, ALL_LEVELS).value_or(0.f);
+        });
+
+        const double fullFirst = measure(rebuilds, [&]
+        {
+            offset = 0.5f - offset;
+            for(auto& phase : phases)
+                phase = std::fmod(phase + offset, 1.f);
+
+            sink += generator.update(gains, phases, 1u).value_or(0.f);
+        });
+
+        //One dragged partial is added to the valid levels as a sinusoid difference
+        generator.update(gains, phases, ALL_LEVELS);
+        int partial = 0;
+        const double delta = measure(rebuilds, [&]
+        {
+            partial = ( partial + 1 ) % 8;
+            gains[(size_t)partial] = 1.f - gains[(size_t)partial];
+
+            sink += generator.update(gains, phases, ALL_LEVELS).value_or(0.f);
+        });
+
+        std::printf("  %-36s %10.1f us\n", "every partial, every level", fullAll * 1.0e6);
+        std::printf("  %-36s %10.1f us\n", "every partial, first level", fullFirst * 1.0e6);
+        std::printf("  %-36s %10.1f us\n", "one partial, every level (delta)", delta * 1.0e6);
+        std::printf("\n");
+    }
+}
+
+//The optional argument scales the number of repetitions, 1 by default
+int main(int argc, char* argv[])
+{
+    const double scale = argc > 1 ? juce::jmax(0.01, juce::String(argv[1]).getDoubleValue()) : 1.0;
+    auto repetitions = [scale](int count) { return juce::jmax(1, juce::roundToInt(count * scale)); };
+
+    Benchmarks::benchmarkInstantiation(repetitions(80));
+    Benchmarks::benchmarkOscillators(repetitions(2000));
+    Benchmarks::benchmarkEngines(repetitions(500));
+    Benchmarks::benchmarkEqualizer(repetitions(2000));
+    Benchmarks::benchmarkWavetableRebuild(repetitions(50));
+
+    std::printf("(checksum %g)\n", (double)Benchmarks::sink);
+    return 0;
+}
@@ -11,20 +11,14 @@
 #pragma once
 
 #include "ChorusProcessor.h"
+#include "../../ParameterSnapshot.h"
 
 #include "../../../View/Effects/Chorus/ChorusEditor.h"
 
 namespace Processor::Effects::Chorus
 {
     ChorusProcessor::ChorusProcessor(juce::AudioProcessorValueTreeState& apvts) : apvts(apvts)
-    {
-        registerListener(this);
-    }
-
-    ChorusProcessor::~ChorusProcessor()
-    {
-        removeListener(this);
-    }
+    {}
 
     void ChorusProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
     {
@@ -35,7 +29,7 @@ namespace Processor::Effects::Chorus
         processSpec.numChannels = getTotalNumOutputChannels();
         processSpec.sampleRate = sampleRate;
         chorus.prepare(processSpec);
-        updateChorusParameters();
+        parametersApplied = false;
     }
 
     void ChorusProcessor::processBlock(juce::AudioBuffer<float> &buffer, juce::MidiBuffer &midiMessages)
@@ -52,42 +46,30 @@ namespace Processor::Effects::Chorus
         chorus.reset();
     }
 
-    void ChorusProcessor::registerListener(juce::AudioProcessorValueTreeState::Listener* listener) const
+    void ChorusProcessor::applyParameters(const ParameterSnapshot& parameters)
     {
-        auto paramLayoutSchema = createParameterLayout();
-        auto params = paramLayoutSchema->getParameters(false);
-
-        for(auto param : params)
+        if( parametersApplied && parameters.chorus == appliedParameters )
         {
-            auto id = dynamic_cast<juce::RangedAudioParameter*>(param)->getParameterID();
-            apvts.addParameterListener(id, listener);
+            return;
         }
-    }
 
-    void ChorusProcessor::removeListener(juce::AudioProcessorValueTreeState::Listener* listener) const
-    {
-        auto paramLayoutSchema = createParameterLayout();
-        auto params = paramLayoutSchema->getParameters(false);
-
-        for(auto param : params)
-        {
-            auto id = dynamic_cast<juce::RangedAudioParameter*>(param)->getParameterID();
-            apvts.removeParameterListener(id, listener);
-        }
+        appliedParameters = parameters.chorus;
+        parametersApplied = true;
+        updateChorusParameters();
     }
 
     void ChorusProcessor::updateChorusParameters()
     {
-        chorus.setMix(apvts.getRawParameterValue("chorusMix")->load()/100);
-        chorus.setRate(apvts.getRawParameterValue("chorusRate")->load());
-        chorus.setCentreDelay(apvts.getRawParameterValue("chorusDelay")->load());
-        chorus.setDepth(apvts.getRawParameterValue("chorusDepth")->load()/100);
-        chorus.setFeedback(apvts.getRawParameterValue("chorusFeedback")->load()/100);
+        chorus.setMix(appliedParameters.mix/100);
+        chorus.setRate(appliedParameters.rate);
+        chorus.setCentreDelay(appliedParameters.delay);
+        chorus.setDepth(appliedParameters.depth/100);
+        chorus.setFeedback(appliedParameters.feedback/100);
     }
 
-    void ChorusProcessor::parameterChanged(const juce::String &parameterID, float newValue)
-    {
-        updateChorusParameters();
+    double ChorusProcessor::getTailLengthSeconds() const
+    {   //juce::dsp::Chorus modulates its delay by up to 20 ms around the centre delay
+        return getFeedbackTailSeconds((appliedParameters.delay + 20.0) / 1000, appliedParameters.feedback / 100);
     }
 
     Editor::Effects::EffectEditor* ChorusProcessor::createEditorUnit()
@@ -16,6 +16,18 @@ namespace Processor::Effects::Chorus
 {
     using Chorus = juce::dsp::Chorus<float>;
 
+    /// @brief The values of the chorus's parameters for one block
+    struct alignas(64) ChorusParameterValues
+    {
+        float mix = 0.f;
+        float rate = 0.f;
+        float delay = 0.f;
+        float depth = 0.f;
+        float feedback = 0.f;
+
+        bool operator==(const ChorusParameterValues&) const = default;
+    };
+
     static std::unique_ptr<juce::AudioProcessorParameterGroup> createParameterLayout()
     {
         std::unique_ptr<juce::AudioProcessorParameterGroup> chorusGroup (
@@ -66,14 +78,13 @@ namespace Processor::Effects::Chorus
     {
     public:
         ChorusProcessor(juce::AudioProcessorValueTreeState& apvts);
-        ~ChorusProcessor() override;
 
         void prepareToPlay(double sampleRate, int samplesPerBlock) override;
         void processBlock(juce::AudioBuffer<float> &buffer, juce::MidiBuffer &midiMessages) override;
         void releaseResources() override;
 
-        void registerListener(juce::AudioProcessorValueTreeState::Listener* listener) const;
-        void removeListener(juce::AudioProcessorValueTreeState::Listener* listener) const;
+        void applyParameters(const ParameterSnapshot& parameters) override;
+        double getTailLengthSeconds() const override;
         
         Editor::Effects::EffectEditor* createEditorUnit() override;
 
@@ -87,7 +98,8 @@ namespace Processor::Effects::Chorus
 
         Chorus chorus;
         
-        void parameterChanged(const juce::String &parameterID, float newValue) override;
+        ChorusParameterValues appliedParameters;    //The values the effect was last updated to
+        bool parametersApplied = false;             //False until the first block after prepareToPlay, which applies every value
 
         void updateChorusParameters();
 
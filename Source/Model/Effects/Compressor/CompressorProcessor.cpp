@@ -9,6 +9,7 @@
 */
 
 #include "CompressorProcessor.h"
+#include "../../ParameterSnapshot.h"
 
 #include "../../../View/Effects/Compressor/CompressorEditor.h"
 
@@ -17,12 +18,6 @@ namespace Processor::Effects::Compressor
     CompressorProcessor::CompressorProcessor(juce::AudioProcessorValueTreeState& apvts) : apvts(apvts)
     {
         dryWetMixer.setMixingRule(juce::dsp::DryWetMixingRule::linear);
-        registerListener(this);
-    }
-
-    CompressorProcessor::~CompressorProcessor()  
-    {
-        removeListener(this);
     }
 
     void CompressorProcessor::prepareToPlay(double sampleRate, int samplesPerBlock) 
@@ -35,7 +30,7 @@ namespace Processor::Effects::Compressor
         processSpec.sampleRate = sampleRate;
         dryWetMixer.prepare(processSpec);
         compressor.prepare(processSpec);
-        updateCompressorParameters();
+        parametersApplied = false;
     }
 
     void CompressorProcessor::processBlock(juce::AudioBuffer<float> &buffer, juce::MidiBuffer &midiMessages) 
@@ -54,42 +49,25 @@ namespace Processor::Effects::Compressor
         compressor.reset();
     }
 
-    void CompressorProcessor::registerListener(juce::AudioProcessorValueTreeState::Listener* listener) const
+    void CompressorProcessor::applyParameters(const ParameterSnapshot& parameters)
     {
-        auto paramLayoutSchema = createParameterLayout();
-        auto params = paramLayoutSchema->getParameters(false);
-
-        for(auto param : params)
+        if( parametersApplied && parameters.compressor == appliedParameters )
         {
-            auto id = dynamic_cast<juce::RangedAudioParameter*>(param)->getParameterID();
-            apvts.addParameterListener(id, listener);
+            return;
         }
-    }
-
-    void CompressorProcessor::removeListener(juce::AudioProcessorValueTreeState::Listener* listener) const
-    {
-        auto paramLayoutSchema = createParameterLayout();
-        auto params = paramLayoutSchema->getParameters(false);
 
-        for(auto param : params)
-        {
-            auto id = dynamic_cast<juce::RangedAudioParameter*>(param)->getParameterID();
-            apvts.removeParameterListener(id, listener);
-        }
+        appliedParameters = parameters.compressor;
+        parametersApplied = true;
+        updateCompressorParameters();
     }
 
     void CompressorProcessor::updateCompressorParameters()
     {
-        dryWetMixer.setWetMixProportion(apvts.getRawParameterValue("compressorMix")->load()/100);
-        compressor.setThreshold(apvts.getRawParameterValue("compressorThreshold")->load());
-        compressor.setRatio(apvts.getRawParameterValue("compressorRatio")->load());
-        compressor.setAttack(apvts.getRawParameterValue("compressorAttack")->load());
-        compressor.setRelease(apvts.getRawParameterValue("compressorRelease")->load());
-    }
-
-    void CompressorProcessor::parameterChanged(const juce::String &parameterID, float newValue) 
-    {
-        updateCompressorParameters();
+        dryWetMixer.setWetMixProportion(appliedParameters.mix/100);
+        compressor.setThreshold(appliedParameters.threshold);
+        compressor.setRatio(appliedParameters.ratio);
+        compressor.setAttack(appliedParameters.attack);
+        compressor.setRelease(appliedParameters.release);
     }
 
     Editor::Effects::EffectEditor* CompressorProcessor::createEditorUnit()
@@ -17,6 +17,18 @@ namespace Processor::Effects::Compressor
     using Compressor = juce::dsp::Compressor<float>;
     using DryWetMixer = juce::dsp::DryWetMixer<float>;
 
+    /// @brief The values of the compressor's parameters for one block
+    struct alignas(64) CompressorParameterValues
+    {
+        float mix = 0.f;
+        float threshold = 0.f;
+        float ratio = 0.f;
+        float attack = 0.f;
+        float release = 0.f;
+
+        bool operator==(const CompressorParameterValues&) const = default;
+    };
+
     static std::unique_ptr<juce::AudioProcessorParameterGroup> createParameterLayout()
     {
         std::unique_ptr<juce::AudioProcessorParameterGroup> compressorGroup (
@@ -73,14 +85,12 @@ namespace Processor::Effects::Compressor
     {
     public:
         CompressorProcessor(juce::AudioProcessorValueTreeState& apvts);
-        ~CompressorProcessor() override ;
 
         void prepareToPlay(double sampleRate, int samplesPerBlock) override;
         void processBlock(juce::AudioBuffer<float> &buffer, juce::MidiBuffer &midiMessages) override;
         void releaseResources() override;
 
-        void registerListener(juce::AudioProcessorValueTreeState::Listener* listener) const;
-        void removeListener(juce::AudioProcessorValueTreeState::Listener* listener) const;
+        void applyParameters(const ParameterSnapshot& parameters) override;
 
         Editor::Effects::EffectEditor* createEditorUnit() override;
 
@@ -95,7 +105,8 @@ namespace Processor::Effects::Compressor
         DryWetMixer dryWetMixer;
         Compressor compressor;
 
-        void parameterChanged(const juce::String &parameterID, float newValue) override;
+        CompressorParameterValues appliedParameters;    //The values the effect was last updated to
+        bool parametersApplied = false;                 //False until the first block after prepareToPlay, which applies every value
 
         void updateCompressorParameters();
 
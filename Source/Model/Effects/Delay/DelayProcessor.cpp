@@ -9,6 +9,7 @@
 */
 
 #include "DelayProcessor.h"
+#include "../../ParameterSnapshot.h"
 
 #include "../../../View/Effects/Delay/DelayEditor.h"
 
@@ -19,12 +20,6 @@ namespace Processor::Effects::Delay
         filters.add(std::make_unique<Filter>());
         filters.add(std::make_unique<Filter>());
         dryWetMixer.setMixingRule(juce::dsp::DryWetMixingRule::linear);
-        registerListener(this);
-    }
-
-    DelayProcessor::~DelayProcessor()
-    {
-        removeListener(this);
     }
 
     void DelayProcessor::prepareToPlay(double sampleRate, int samplesPerBlock) 
@@ -49,7 +44,7 @@ namespace Processor::Effects::Delay
             filter->prepare(filterSpec);
         }
 
-        updateDelayParameters();
+        parametersApplied = false;
     }
 
     void DelayProcessor::processBlock(juce::AudioBuffer<float> &buffer, juce::MidiBuffer &midiMessages) 
@@ -85,52 +80,43 @@ namespace Processor::Effects::Delay
         delay.reset();
     }
 
-    void DelayProcessor::registerListener(juce::AudioProcessorValueTreeState::Listener* listener) const
+    void DelayProcessor::applyParameters(const ParameterSnapshot& parameters)
     {
-        auto paramLayoutSchema = createParameterLayout();
-        auto params = paramLayoutSchema->getParameters(false);
-
-        for(auto param : params)
+        if( parametersApplied && parameters.delay == appliedParameters )
         {
-            auto id = dynamic_cast<juce::RangedAudioParameter*>(param)->getParameterID();
-            apvts.addParameterListener(id, listener);
+            return;
         }
-    }
-
-    void DelayProcessor::removeListener(juce::AudioProcessorValueTreeState::Listener* listener) const
-    {
-        auto paramLayoutSchema = createParameterLayout();
-        auto params = paramLayoutSchema->getParameters(false);
 
-        for(auto param : params)
-        {
-            auto id = dynamic_cast<juce::RangedAudioParameter*>(param)->getParameterID();
-            apvts.removeParameterListener(id, listener);
-        }
+        appliedParameters = parameters.delay;
+        parametersApplied = true;
+        updateDelayParameters();
     }
 
     void DelayProcessor::updateDelayParameters()
     {
         if(getSampleRate() > 0)
         {
-            dryWetMixer.setWetMixProportion(apvts.getRawParameterValue("delayMix")->load()/100);
-            feedback = apvts.getRawParameterValue("delayFeedback")->load()/100;
-            delay.setDelay( (float)std::round( ( apvts.getRawParameterValue("delayTime")->load() / 1000 ) * getSampleRate() ) );
-            float freq = apvts.getRawParameterValue("delayFilterFrequency")->load();
-            float q = apvts.getRawParameterValue("delayFilterQ")->load();
-
+            dryWetMixer.setWetMixProportion(appliedParameters.mix/100);
+            feedback = appliedParameters.feedback/100;
+            delay.setDelay( (float)std::round( ( appliedParameters.time / 1000 ) * getSampleRate() ) );
+            float freq = appliedParameters.filterFrequency;
+            float q = appliedParameters.filterQ;
+
+            //Written into the existing coefficients, so the update doesn't allocate on the audio thread
+            const auto coefficients = ArrayCoefficients::makeBandPass(getSampleRate(), freq, q);
             for(auto& filter : filters)
             {
-                filter->coefficients = Coefficients::makeBandPass(getSampleRate(), freq, q);
+                *filter->coefficients = coefficients;
             }
         }
     }
 
-    void DelayProcessor::parameterChanged(const juce::String &parameterID, float newValue) 
-    {
-        updateDelayParameters();
+    double DelayProcessor::getTailLengthSeconds() const
+    {   //Every echo passes the band-pass once more, which only shortens the tail
+        return getFeedbackTailSeconds(appliedParameters.time / 1000, appliedParameters.feedback / 100)
+               + getResonanceTailSeconds(appliedParameters.filterFrequency, appliedParameters.filterQ);
     }
-    
+
     Editor::Effects::EffectEditor* DelayProcessor::createEditorUnit()
     {
         return new Editor::Effects::DelayEditor(apvts);
@@ -17,10 +17,23 @@ namespace Processor::Effects::Delay
     using Delay = juce::dsp::DelayLine<float>;
     using Filter = juce::dsp::IIR::Filter<float>;
     using Coefficients = juce::dsp::IIR::Coefficients<float>;
+    using ArrayCoefficients = juce::dsp::IIR::ArrayCoefficients<float>;
     using DryWetMixer = juce::dsp::DryWetMixer<float>;
 
     constexpr float MAX_LENGTH_MS = 1000.f;
 
+    /// @brief The values of the delay's parameters for one block
+    struct alignas(64) DelayParameterValues
+    {
+        float mix = 0.f;
+        float feedback = 0.f;
+        float time = 0.f;
+        float filterFrequency = 0.f;
+        float filterQ = 0.f;
+
+        bool operator==(const DelayParameterValues&) const = default;
+    };
+
     static std::unique_ptr<juce::AudioProcessorParameterGroup> createParameterLayout()
     {
         std::unique_ptr<juce::AudioProcessorParameterGroup> delayGroup (
@@ -71,14 +84,13 @@ namespace Processor::Effects::Delay
     {
     public:
         DelayProcessor(juce::AudioProcessorValueTreeState& apvts);
-        ~DelayProcessor();
 
         void prepareToPlay(double sampleRate, int samplesPerBlock) override;
         void processBlock(juce::AudioBuffer<float> &buffer, juce::MidiBuffer &midiMessages) override;
         void releaseResources() override;
 
-        void registerListener(juce::AudioProcessorValueTreeState::Listener* listener) const;
-        void removeListener(juce::AudioProcessorValueTreeState::Listener* listener) const;
+        void applyParameters(const ParameterSnapshot& parameters) override;
+        double getTailLengthSeconds() const override;
 
         Editor::Effects::EffectEditor* createEditorUnit() override;
 
@@ -94,9 +106,10 @@ namespace Processor::Effects::Delay
         Delay delay;
         juce::OwnedArray<Filter> filters;
 
-        std::atomic<float> feedback = 0;
+        float feedback = 0;
 
-        void parameterChanged(const juce::String &parameterID, float newValue) override;
+        DelayParameterValues appliedParameters;    //The values the effect was last updated to
+        bool parametersApplied = false;            //False until the first block after prepareToPlay, which applies every value
 
         void updateDelayParameters();
 
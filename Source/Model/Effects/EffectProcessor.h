@@ -14,10 +14,34 @@
 
 #include "../../View/Effects/EffectEditor.h"
 
+namespace Processor
+{
+    struct ParameterSnapshot;
+}
+
 namespace Processor::Effects
 {
-    class EffectProcessor : public juce::AudioProcessor,
-                            public juce::AudioProcessorValueTreeState::Listener
+    constexpr float FX_SILENCE_THRESHOLD = 1.0e-5f;         //-100 dBFS, a block whose peak is below this counts as silent
+
+    /// @brief Estimates how long a signal circulating in a feedback loop takes to fall below the silence threshold
+    /// @param loopSeconds The length of one pass through the loop
+    /// @param feedback The gain of each pass
+    static double getFeedbackTailSeconds(double loopSeconds, double feedback)
+    {
+        if( feedback <= 0.0 )
+            return loopSeconds;
+
+        const double passes = std::log(FX_SILENCE_THRESHOLD) / std::log(juce::jmin(feedback, 0.999));
+        return loopSeconds * (passes + 1.0);
+    }
+
+    /// @brief Estimates how long a resonant filter rings until it falls below the silence threshold. Its envelope decays with a time constant of Q / (pi * f)
+    static double getResonanceTailSeconds(double frequency, double q)
+    {
+        return -std::log(FX_SILENCE_THRESHOLD) * q / ( juce::MathConstants<double>::pi * juce::jmax(frequency, 1.0) );
+    }
+
+    class EffectProcessor : public juce::AudioProcessor
     {
     public:
         EffectProcessor() : AudioProcessor(BusesProperties().withInput("Input", juce::AudioChannelSet::stereo())
@@ -34,6 +58,8 @@ namespace Processor::Effects
         const juce::String getName() const override { return "Empty"; }
         bool acceptsMidi() const override { return true; }
         bool producesMidi() const override { return true; }
+
+        /// @brief How long the effect keeps sounding after its input went silent, estimated from the values it applied last. The chain stops processing the effect once its input has been silent for this long
         double getTailLengthSeconds() const override { return 0; }
 
         int getNumPrograms() override { return 0; }
@@ -47,7 +73,10 @@ namespace Processor::Effects
 
         //=================================================================//
         virtual Editor::Effects::EffectEditor* createEditorUnit() { return nullptr; }
-        void parameterChanged (const juce::String& parameterID, float newValue) override {}
+
+        /// @brief Updates the effect to the parameter values of the current block. Called on the audio thread right before processBlock, so it must not allocate.
+        /// Effects keep the values they applied last and only recalculate when their own values have changed
+        virtual void applyParameters(const ParameterSnapshot&) {}
 
     private:
         JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(EffectProcessor)
@@ -10,164 +10,267 @@
 
 #include <JuceHeader.h>
 #include "EffectProcessorChain.h"
+#include "../ParameterSnapshot.h"
+#include "../ParameterRegistry.h"
 
 namespace Processor::Effects::EffectsChain
 {
-    EffectProcessorChain::EffectProcessorChain(juce::AudioProcessorValueTreeState& apvts) : apvts(apvts)
+    EffectProcessorChain::EffectProcessorChain(juce::AudioProcessorValueTreeState& apvts, ParameterRegistry& registry, const ParameterSnapshot& blockParameters) :
+        apvts(apvts),
+        registry(registry),
+        blockParameters(blockParameters)
     {
         for(int i = 0; i < FX_MAX_SLOTS ; i++)
         {
             chain.add(std::make_unique<EffectSlot>());
         }
 
-        registerListener(this);
+        pool[Empty].processor = std::make_unique<EffectProcessor>();
+        pool[EQ].processor = std::make_unique<Equalizer::EqualizerProcessor>(apvts);
+        pool[Filter].processor = std::make_unique<Filter::FilterProcessor>(apvts);
+        pool[Compressor].processor = std::make_unique<Compressor::CompressorProcessor>(apvts);
+        pool[Delay].processor = std::make_unique<Delay::DelayProcessor>(apvts);
+        pool[Reverb].processor = std::make_unique<Reverb::ReverbProcessor>(apvts);
+        pool[Chorus].processor = std::make_unique<Chorus::ChorusProcessor>(apvts);
+        pool[Phaser].processor = std::make_unique<Phaser::PhaserProcessor>(apvts);
+        pool[Tremolo].processor = std::make_unique<Tremolo::TremoloProcessor>(apvts);
+
+        //The bypass and choice parameters of the slots are the last two ranges of the registry
+        registry.addListener(this, ParameterIndex::fxBypass, ParameterIndex::count, [this] (int parameterIndex, float newValue)
+        {
+            slotParameterChanged(parameterIndex, newValue);
+        });
+        startTimer(50);
     }
 
     EffectProcessorChain::~EffectProcessorChain()
     {
-        removeListener(this);
+        stopTimer();
+        registry.removeListener(this);
     }
 
     void EffectProcessorChain::prepareToPlay(double sampleRate, int samplesPerBlock)
     {
         setPlayConfigDetails(getMainBusNumInputChannels(), getMainBusNumOutputChannels(), sampleRate, samplesPerBlock);
-        for(auto item : chain)
+
+        //Every effect is prepared here, whether it's loaded or not, so loading one later never allocates
+        const juce::ScopedLock lock(poolLock);
+        for(auto& effect : pool)
         {
-            item->processor.load()->prepareToPlay(sampleRate, samplesPerBlock);
+            effect.processor->prepareToPlay(sampleRate, samplesPerBlock);
         }
     }
 
     void EffectProcessorChain::processBlock(juce::AudioSampleBuffer &buffer, juce::MidiBuffer &midiMessages)
     {
-        for(auto item : chain)
+        //Counted before the routing is read, so an effect retired after this point is only reset once this block has finished
+        const auto block = blocksStarted.fetch_add(1) + 1;
+        const auto blockRouting = routing.load();
+
+        const int numSamples = buffer.getNumSamples();
+
+        for(int i = 0; i < FX_MAX_SLOTS; i++)
         {
-            if( !item->bypass )
+            const int choice = getSlotChoice(blockRouting, i);
+            auto& activity = slotActivity[(size_t)i];
+
+            if( choice == Empty || isSlotBypassed(blockRouting, i) )
+            {   //Starts awake once it is loaded or enabled again
+                activity = {};
+                continue;
+            }
+
+            if( activity.choice != choice )
+                activity = { choice };
+
+            auto& processor = *pool[(size_t)choice].processor;
+            processor.applyParameters(blockParameters);     //Kept up to date while sleeping, so the effect wakes with the current values
+
+            const bool inputSilent = buffer.getMagnitude(0, numSamples) < FX_SILENCE_THRESHOLD;
+            if( inputSilent && activity.sleeping )
+            {   //The tail has decayed and silence in gives silence out, the buffer passes through untouched
+                continue;
+            }
+
+            processor.processBlock(buffer, midiMessages);
+
+            if( inputSilent )
             {
-                item->processor.load()->processBlock(buffer, midiMessages);
+                activity.silentSamples += numSamples;
+                activity.sleeping = activity.silentSamples >= processor.getTailLengthSeconds() * getSampleRate()
+                                    && buffer.getMagnitude(0, numSamples) < FX_SILENCE_THRESHOLD;
             }
+            else
+            {
+                activity.silentSamples = 0;
+                activity.sleeping = false;
+            }
+        }
+
+        blocksFinished.store(block, std::memory_order_release);
+
+        if( hasRetiredEffects() )
+        {   //The effects retired during this block can be reset now
+            chainWorker.requestFollowUp();
         }
     }
 
     void EffectProcessorChain::releaseResources()
     {
-        for(auto item : chain)
+        const juce::ScopedLock lock(poolLock);
+        for(auto& effect : pool)
         {
-            item->processor.load()->releaseResources();
+            effect.processor->releaseResources();
         }
     }
 
-    void EffectProcessorChain::registerListener(juce::AudioProcessorValueTreeState::Listener* listener) const
+    const juce::Array<Editor::Effects::EffectEditor*> EffectProcessorChain::getLoadedEffectEditors() const
     {
-        auto paramLayoutSchema = createParameterLayout();
-        auto params = paramLayoutSchema->getParameters(false);
+        juce::Array<Editor::Effects::EffectEditor*> editorComponents;
 
-        for(auto param : params)
+        //A choice that is still in its mailbox is shown already, the worker loads it within milliseconds
+        const auto currentRouting = routing.load();
+        for(int i = 0; i < FX_MAX_SLOTS; i++)
         {
-            auto id = dynamic_cast<juce::RangedAudioParameter*>(param)->getParameterID();
-            apvts.addParameterListener(id, listener);
+            const int requested = chain[i]->requestedChoice.load();
+            const int choice = requested >= 0 ? requested : getSlotChoice(currentRouting, i);
+            editorComponents.add( pool[(size_t)choice].processor->createEditorUnit() );
         }
+
+        return editorComponents;
     }
 
-    void EffectProcessorChain::removeListener(juce::AudioProcessorValueTreeState::Listener* listener) const
+    void EffectProcessorChain::slotParameterChanged(int parameterIndex, float newValue)
     {
-        auto paramLayoutSchema = createParameterLayout();
-        auto params = paramLayoutSchema->getParameters(false);
+        if(parameterIndex < ParameterIndex::fxChoice)
+        {
+            setSlotBypass(parameterIndex - ParameterIndex::fxBypass, bool(newValue));
+        }
+        else
+        {
+            jassert(juce::isPositiveAndBelow(newValue, chainChoices.size()));
+            int idx = parameterIndex - ParameterIndex::fxChoice;
 
-        for(auto param : params)
+            chain[idx]->requestedChoice = int(newValue);
+
+            //Host automation can arrive on the audio thread, the request never blocks it
+            chainWorker.request();
+        }
+    }
+
+    void EffectProcessorChain::timerCallback()
+    {
+        for(int i = 0; i < chain.size(); i++)
         {
-            auto id = dynamic_cast<juce::RangedAudioParameter*>(param)->getParameterID();
-            apvts.removeParameterListener(id, listener);
+            if( chain[i]->choiceRejected.exchange(false) )
+            {   //Every effect can only be in one slot, the slot was loaded with empty instead
+                auto thisParam = dynamic_cast<juce::AudioParameterChoice*>(apvts.getParameter(getFXChoiceParameterID(i)));
+                thisParam->setValueNotifyingHost(thisParam->convertTo0to1(Empty));
+            }
         }
     }
 
-    const juce::Array<Editor::Effects::EffectEditor*> EffectProcessorChain::getLoadedEffectEditors() const
+    void EffectProcessorChain::setSlotBypass(int index, bool shouldBeBypassed)
     {
-        juce::Array<Editor::Effects::EffectEditor*> editorComponents;
+        const uint64_t bypassBit = uint64_t(1) << (FX_MAX_SLOTS * FX_CHOICE_BITS + index);
+        updateRouting([&] (uint64_t current) { return shouldBeBypassed ? current | bypassBit : current & ~bypassBit; });
+    }
 
-        for(auto item : chain)
+    void EffectProcessorChain::applyRequestedChoices()
+    {
+        for(int i = 0; i < chain.size(); i++)
         {
-            editorComponents.add( item->processor.load()->createEditorUnit() );
+            auto choice = chain[i]->requestedChoice.exchange(-1);
+            if( choice >= 0 )
+            {
+                loadEffect(i, static_cast<EffectChoices>(choice));
+            }
         }
-
-        return editorComponents;
     }
 
-    void EffectProcessorChain::parameterChanged(const juce::String &parameterID, float newValue)
+    void EffectProcessorChain::loadEffect(int index, EffectChoices choice)
     {
-        if(parameterID.contains("fxBypass"))
+        if( !juce::isPositiveAndBelow(int(choice), FX_CHOICE_COUNT) )
+            return;
+
+        const int previous = getSlotChoice(routing.load(), index);
+        if( previous == choice )
+            return;
+
+        if( choice != Empty )
         {
-            int idx = getFXIndexFromBypassParameterID(parameterID);
+            auto& effect = pool[(size_t)choice];
+
+            if( effect.state.load() == PooledEffectState::inUse )
+            {   //Every effect can only be in one slot, load empty instead
+                chain[index]->choiceRejected = true;
+                choice = Empty;
+            }
+            else
+            {   //An effect that was just taken out of another slot and isn't reset yet moves over with its state, which keeps re-ordering the rack seamless.
+                //The resets run on this thread as well, so the effect can't be in the middle of one
+                jassert(effect.state.load() != PooledEffectState::resetting);
+                effect.state = PooledEffectState::inUse;
+            }
+        }
+
+        const uint64_t choiceMask = uint64_t((1u << FX_CHOICE_BITS) - 1) << (index * FX_CHOICE_BITS);
+        const uint64_t choiceBits = uint64_t(choice) << (index * FX_CHOICE_BITS);
+        const auto replaced = updateRouting([&] (uint64_t current) { return ( current & ~choiceMask ) | choiceBits; });
+
+        retireEffect(getSlotChoice(replaced, index));
+    }
+
+    void EffectProcessorChain::retireEffect(int choice)
+    {
+        if( choice == Empty )
+            return;
 
-            chain[idx]->bypass = bool(newValue);
+        //Read after the routing was swapped, so every block that can still see the effect started no later than this one
+        pool[(size_t)choice].retiredInBlock = blocksStarted.load();
+        pool[(size_t)choice].state = PooledEffectState::retired;
+    }
 
-            if( chain[idx]->bypass )
-                chain[idx]->processor.load()->releaseResources();
-            else if( getSampleRate() > 0 )
-                chain[idx]->processor.load()->prepareToPlay(getSampleRate(), getBlockSize());
+    bool EffectProcessorChain::hasRetiredEffects() const
+    {
+        for(const auto& effect : pool)
+        {
+            if( effect.state.load(std::memory_order_relaxed) == PooledEffectState::retired )
+                return true;
         }
-        else if(parameterID.contains("fxChoice"))
+        return false;
+    }
+
+    void EffectProcessorChain::resetRetiredEffects()
+    {
+        const juce::ScopedLock lock(poolLock);
+        const auto finished = blocksFinished.load(std::memory_order_acquire);
+
+        for(auto& effect : pool)
         {
-            jassert(juce::isPositiveAndBelow(newValue, chainChoices.size()));
-            int idx = getFXIndexFromChoiceParameterID(parameterID);
+            //Claimed before the block is checked, so a slot can't take the effect and retire it again in between
+            auto expected = PooledEffectState::retired;
+            if( !effect.state.compare_exchange_strong(expected, PooledEffectState::resetting) )
+                continue;
 
-            auto choice = static_cast<EffectChoices>(newValue);
-            std::unique_ptr<Effects::EffectProcessor> newProcessor;
-            switch (choice)
-            {
-            case Empty:
-                newProcessor = std::make_unique<EffectProcessor>();
-                break;
-            case EQ:
-                newProcessor = std::make_unique<Equalizer::EqualizerProcessor>(apvts);
-                break;
-            case Filter:
-                newProcessor = std::make_unique<Filter::FilterProcessor>(apvts);
-                break;
-            case Compressor:
-                newProcessor = std::make_unique<Compressor::CompressorProcessor>(apvts);
-                break;
-            case Delay:
-                newProcessor = std::make_unique<Delay::DelayProcessor>(apvts);
-                break;
-            case Reverb:
-                newProcessor = std::make_unique<Reverb::ReverbProcessor>(apvts);
-                break;
-            case Chorus:
-                newProcessor = std::make_unique<Chorus::ChorusProcessor>(apvts);
-                break;
-            case Phaser:
-                newProcessor = std::make_unique<Phaser::PhaserProcessor>(apvts);
-                break;
-            case Tremolo:
-                newProcessor = std::make_unique<Tremolo::TremoloProcessor>(apvts);
-                break;
-            default:
-                return;
+            if( finished < effect.retiredInBlock.load() )
+            {   //The audio thread may still be processing it, it asks again when the block is done
+                effect.state = PooledEffectState::retired;
+                continue;
             }
 
-            //If the selected choice is Empty or isn't already on the chain, add it
-            if( choice == Empty || !isProcessorInChain(*newProcessor) )
-            {
-                if( getSampleRate() > 0 )
-                {
-                    newProcessor->prepareToPlay(getSampleRate(), getBlockSize());
-                }
-                chain[idx]->processor.store(std::move(newProcessor));
-            }
-            else    //If the new parameter is already in the chain, discard it and load empty instead
-            {
-                auto thisParam = dynamic_cast<juce::AudioParameterChoice*>(apvts.getParameter(parameterID));
-                thisParam->setValueNotifyingHost(thisParam->convertTo0to1(Empty));
-                chain[idx]->processor.store(std::make_unique<EffectProcessor>());
-            }
+            //releaseResources clears the effect's buffers and filters without freeing them
+            effect.processor->releaseResources();
+            effect.state = PooledEffectState::ready;
         }
     }
 
     bool EffectProcessorChain::isProcessorInChain(const EffectProcessor& processor) const
     {
-        for(const auto& item : chain)
+        const auto currentRouting = routing.load();
+        for(int i = 0; i < FX_MAX_SLOTS; i++)
         {
-            if( typeid( *item->processor.load() ) == typeid( processor ) )
+            if( pool[(size_t)getSlotChoice(currentRouting, i)].processor.get() == &processor )
             {
                 return true;
             }
@@ -20,28 +20,46 @@
 #include "Chorus/ChorusProcessor.h"
 #include "Phaser/PhaserProcessor.h"
 #include "Tremolo/TremoloProcessor.h"
+#include "../../Utils/CoalescingWorker.h"
+
+namespace Processor
+{
+    class ParameterRegistry;
+}
 
 namespace Processor::Effects::EffectsChain
 {
     static const juce::StringArray chainChoices = { "Empty", "EQ", "Fliter", "Compressor", "Delay", "Reverb", "Chorus", "Phaser", "Tremolo" };
     enum EffectChoices { Empty = 0, EQ = 1, Filter = 2, Compressor = 3, Delay = 4, Reverb = 5, Chorus = 6, Phaser = 7, Tremolo = 8 };
 
-    const int FX_MAX_SLOTS = chainChoices.size() - 1;
+    constexpr int FX_MAX_SLOTS = Tremolo;                   //One slot for every effect
+    constexpr int FX_CHOICE_COUNT = Tremolo + 1;
+    constexpr int FX_CHOICE_BITS = 4;                       //The bits of a slot's choice in the chain's routing word
 
-    struct EffectSlot
+    static_assert(FX_CHOICE_COUNT <= (1 << FX_CHOICE_BITS) && FX_MAX_SLOTS * (FX_CHOICE_BITS + 1) <= 64, "Every slot's choice and bypass have to fit into the routing word");
+
+    /// @brief The lifecycle of a pooled effect. A slot can load an effect that is ready, or one that is retired and not reset yet, which keeps its state
+    enum class PooledEffectState
     {
-        EffectSlot(bool bypass, std::shared_ptr<EffectProcessor> newProcessor) :
-            bypass(bypass),
-            processor(newProcessor)
-        {}
+        ready,          //Prepared and reset, in no slot
+        inUse,          //In a slot
+        retired,        //Taken out of its slot, waiting for the audio thread to let go of it and for the reset
+        resetting       //Being reset on the background thread
+    };
 
-        EffectSlot()
-        {
-            processor.store(std::make_shared<EffectProcessor>());
-        }
+    /// @brief One effect of every type, created and prepared up front so loading it into a slot never allocates
+    struct PooledEffect
+    {
+        std::unique_ptr<EffectProcessor> processor;
+        std::atomic<PooledEffectState> state { PooledEffectState::ready };
+        std::atomic<uint64_t> retiredInBlock { 0 };         //The last block that may have processed the effect before it was retired
+    };
 
-        std::atomic<bool> bypass {false};
-        std::atomic<std::shared_ptr<EffectProcessor>> processor;
+    /// @brief The mailbox of a slot. Any thread can post a choice, the chain's worker takes it. Only the latest choice of a slot matters, so a newer one replaces one that is still waiting
+    struct EffectSlot
+    {
+        std::atomic<int> requestedChoice {-1};              //-1 if there's none
+        std::atomic<bool> choiceRejected {false};           //Set by the worker if the choice was already in another slot, the timer then resets the parameter on the message thread
     };
 
     /// @brief Used for making the parameter ids of the the FX slots' bypass parameters consistent
@@ -53,13 +71,6 @@ namespace Processor::Effects::EffectsChain
         return "fxBypass" + juce::String(index);
     }
 
-    static const int getFXIndexFromBypassParameterID(const juce::String paramID)
-    {
-        int index = std::stoi(paramID.trimCharactersAtStart("fxBypass").toStdString());
-        jassert(juce::isPositiveAndBelow(index, FX_MAX_SLOTS));
-        return index;
-    }
-
     /// @brief Used for making the parameter ids of the the FX slots' choice parameters consistent
     /// @param index The index of the effect
     /// @return A parameter id
@@ -69,13 +80,6 @@ namespace Processor::Effects::EffectsChain
         return "fxChoice" + juce::String(index);
     }
 
-    static const int getFXIndexFromChoiceParameterID(const juce::String paramID)
-    {
-        int index = std::stoi(paramID.trimCharactersAtStart("fxChoice").toStdString());
-        jassert(juce::isPositiveAndBelow(index, FX_MAX_SLOTS));
-        return index;
-    }
-
     static std::unique_ptr<juce::AudioProcessorParameterGroup> createParameterLayout()
     {
         std::unique_ptr<juce::AudioProcessorParameterGroup> fxChainGroup (
@@ -105,11 +109,18 @@ namespace Processor::Effects::EffectsChain
         return fxChainGroup;
     }
 
+    /// @brief Processes the loaded effects in order. Every effect type is created and prepared once, up front, and the slots only hold indices into that pool.
+    /// Slot choices are posted to the slots' mailboxes from any thread and applied by the chain's worker thread, never inline in the parameter callback.
+    /// The choice and bypass of every slot are packed into one atomic routing word, which the audio thread reads once at the start of each block, so it sees the whole rack change at once.
+    /// Effects taken out of a slot are reset on the worker once the audio thread has finished the last block that could have used them.
+    /// A slot whose input has been silent for longer than its effect's tail, and whose output is silent, sleeps until its input is audible again
     class EffectProcessorChain : public juce::AudioProcessor,
-                                 public juce::AudioProcessorValueTreeState::Listener
+                                 private juce::Timer
     {
     public:
-        EffectProcessorChain(juce::AudioProcessorValueTreeState&);
+        /// @param blockParameters The parameter values of the current block, updated by the owner before every processBlock
+        /// @param registry Notifies the chain of the slot parameters' changes, by index
+        EffectProcessorChain(juce::AudioProcessorValueTreeState&, ParameterRegistry& registry, const ParameterSnapshot& blockParameters);
 
         ~EffectProcessorChain();
 
@@ -135,20 +146,70 @@ namespace Processor::Effects::EffectsChain
         void releaseResources() override;
         void processBlock(juce::AudioSampleBuffer &buffer, juce::MidiBuffer &midiMessages) override;
 
-        void registerListener(juce::AudioProcessorValueTreeState::Listener*) const;
-        void removeListener(juce::AudioProcessorValueTreeState::Listener*) const;
-        
         const juce::Array<Editor::Effects::EffectEditor*> getLoadedEffectEditors() const;
 
         bool isProcessorInChain(const EffectProcessor& processor) const;
 
     private:
         juce::AudioProcessorValueTreeState& apvts;
-        std::unordered_map<juce::String, std::atomic<float>> paramMap;
+        ParameterRegistry& registry;
+        const ParameterSnapshot& blockParameters;
 
         juce::OwnedArray<EffectSlot> chain;
+        std::array<PooledEffect, FX_CHOICE_COUNT> pool;     //Indexed by EffectChoices
+        juce::CriticalSection poolLock;                     //Keeps the resets away from prepareToPlay and releaseResources, never taken on the audio thread
+
+        /// @brief The silence tracking of one slot, only touched by the audio thread
+        struct SlotActivity
+        {
+            int choice = Empty;                             //The effect the tracking belongs to, a new one starts awake
+            juce::int64 silentSamples = 0;                  //The number of samples since the slot's input went silent
+            bool sleeping = false;
+        };
+
+        std::array<SlotActivity, FX_MAX_SLOTS> slotActivity;
+
+        std::atomic<uint64_t> routing { 0 };                //The choice of every slot in FX_CHOICE_BITS each, followed by a bypass bit per slot
+        std::atomic<uint64_t> blocksStarted { 0 };
+        std::atomic<uint64_t> blocksFinished { 0 };
+
+        Utils::CoalescingWorker chainWorker { "Effect Chain", [&] () { applyRequestedChoices(); resetRetiredEffects(); } };
+
+        static int getSlotChoice(uint64_t routingWord, int index) { return int( ( routingWord >> (index * FX_CHOICE_BITS) ) & ( (1u << FX_CHOICE_BITS) - 1 ) ); }
+        static bool isSlotBypassed(uint64_t routingWord, int index) { return ( routingWord >> (FX_MAX_SLOTS * FX_CHOICE_BITS + index) ) & 1u; }
+
+        /// @brief Changes the routing word with a compare and swap loop. Lock free, so bypasses can be set from any thread
+        template <typename Function>
+        uint64_t updateRouting(Function&& change)
+        {
+            auto current = routing.load();
+            while( !routing.compare_exchange_weak(current, change(current)) ) {}
+            return current;
+        }
+
+        /// @brief Called by the registry when a slot's bypass or choice parameter changes
+        void slotParameterChanged(int parameterIndex, float newValue);
+
+        /// @brief Sets the parameters of rejected choices back to empty, on the message thread
+        void timerCallback() override;
+
+        /// @brief Bypasses or enables a slot. Every effect is prepared, so this is one atomic update and safe on any thread
+        void setSlotBypass(int index, bool shouldBeBypassed);
+
+        /// @brief Takes the choices out of the slots' mailboxes and loads them. Runs on the worker
+        void applyRequestedChoices();
+
+        /// @brief Swaps the chosen effect from the pool into the slot, and retires the one it replaces. Runs on the worker
+        void loadEffect(int index, EffectChoices choice);
+
+        /// @brief Marks an effect that was taken out of its slot for the reset. Runs on the worker
+        void retireEffect(int choice);
+
+        /// @return True if an effect is waiting for the audio thread to let go of it
+        bool hasRetiredEffects() const;
 
-        void parameterChanged(const juce::String &parameterID, float newValue) override;
+        /// @brief Resets the retired effects the audio thread no longer uses and returns them to the pool. Runs on the reset worker
+        void resetRetiredEffects();
 
         //==============================================================================
         JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(EffectProcessorChain)
@@ -0,0 +1,244 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+namespace Processor::Effects::Equalizer
+{
+    using SIMDDouble = juce::dsp::SIMDRegister<double>;
+
+    constexpr int CASCADE_CHANNELS = 2;                     //The cascade filters the channels side by side, one per SIMD lane
+    constexpr int DOUBLE_LANES = (int)SIMDDouble::SIMDNumElements;
+
+    static_assert(DOUBLE_LANES >= CASCADE_CHANNELS, "Both channels have to fit into one register");
+
+    /// @brief The coefficients of one biquad section, divided by a0
+    struct BiquadCoefficients
+    {
+        double b0 = 1.0;
+        double b1 = 0.0;
+        double b2 = 0.0;
+        double a1 = 0.0;
+        double a2 = 0.0;
+
+        /// @brief The peaking filter of the Audio EQ Cookbook. The same response as juce's makePeakFilter, computed in double precision so the low bands stay accurate
+        /// @param gainFactor The linear gain at the centre frequency
+        static BiquadCoefficients makePeak(double sampleRate, double frequency, double q, double gainFactor)
+        {
+            jassert(sampleRate > 0.0 && frequency > 0.0 && frequency <= sampleRate * 0.5 && q > 0.0);
+
+            const double A = std::sqrt(juce::jmax(gainFactor, 1.0e-15));
+            const double omega = juce::MathConstants<double>::twoPi * frequency / sampleRate;
+            const double alpha = std::sin(omega) / ( 2.0 * q );
+            const double cosine = -2.0 * std::cos(omega);
+            const double a0 = 1.0 + alpha / A;
+
+            BiquadCoefficients coefficients;
+            coefficients.b0 = ( 1.0 + alpha * A ) / a0;
+            coefficients.b1 = cosine / a0;
+            coefficients.b2 = ( 1.0 - alpha * A ) / a0;
+            coefficients.a1 = cosine / a0;
+            coefficients.a2 = ( 1.0 - alpha / A ) / a0;
+            return coefficients;
+        }
+    };
+
+    /// @brief A series of biquad sections in transposed direct form II that filters two channels at once, each channel in its own lane of a double register.
+    /// Sections can be switched off, the cascade then skips them entirely
+    template <int MaxSections>
+    class BiquadCascade
+    {
+    public:
+        /// @brief Turns a section on with the given coefficients. A section that was off starts from silence
+        void setSection(int index, const BiquadCoefficients& coefficients) noexcept
+        {
+            auto& section = sections[(size_t)index];
+            if( !section.enabled )
+            {
+                section.s1 = 0.0;
+                section.s2 = 0.0;
+            }
+
+            section.b0 = coefficients.b0;
+            section.b1 = coefficients.b1;
+            section.b2 = coefficients.b2;
+            section.a1 = coefficients.a1;
+            section.a2 = coefficients.a2;
+            section.enabled = true;
+
+            updateEnabledSections();
+        }
+
+        /// @brief Turns a section off, for example a peaking band at 0 dB that would pass the signal through unchanged
+        void disableSection(int index) noexcept
+        {
+            sections[(size_t)index].enabled = false;
+            updateEnabledSections();
+        }
+
+        void reset() noexcept
+        {
+            for(auto& section : sections)
+            {
+                section.s1 = 0.0;
+                section.s2 = 0.0;
+            }
+        }
+
+        /// @return True if every section is off, so processing would leave the signal untouched
+        bool isBypassed() const noexcept { return enabledCount == 0; }
+
+        /// @brief Filters the samples in place
+        /// @param right The second channel, or nullptr for a mono signal which then only occupies the first lane
+        void process(float* left, float* right, int numSamples) noexcept
+        {
+            if( isBypassed() )
+                return;
+
+            //The samples are widened into interleaved frames a chunk at a time, so the cascade reads and writes whole registers
+            for(int start = 0; start < numSamples; start += CASCADE_CHUNK)
+            {
+                const int chunk = juce::jmin(CASCADE_CHUNK, numSamples - start);
+                for(int i = 0; i < chunk; i++)
+                {
+                    frames[(size_t)( i * DOUBLE_LANES )] = left[start + i];
+                    frames[(size_t)( i * DOUBLE_LANES + 1 )] = right != nullptr ? right[start + i] : 0.0;
+                }
+
+                filterFrames(chunk);
+
+                for(int i = 0; i < chunk; i++)
+                {
+                    left[start + i] = (float)frames[(size_t)( i * DOUBLE_LANES )];
+                    if( right != nullptr )
+                        right[start + i] = (float)frames[(size_t)( i * DOUBLE_LANES + 1 )];
+                }
+            }
+        }
+
+    private:
+        /// @brief The coefficients are broadcast to every lane up front, so the loop never expands a scalar
+        struct Section
+        {
+            SIMDDouble b0 = SIMDDouble::expand(1.0);
+            SIMDDouble b1 = SIMDDouble::expand(0.0);
+            SIMDDouble b2 = SIMDDouble::expand(0.0);
+            SIMDDouble a1 = SIMDDouble::expand(0.0);
+            SIMDDouble a2 = SIMDDouble::expand(0.0);
+
+            SIMDDouble s1 = SIMDDouble::expand(0.0);        //The two delayed states of the transposed direct form, one lane per channel
+            SIMDDouble s2 = SIMDDouble::expand(0.0);
+            bool enabled = false;
+        };
+
+        std::array<Section, MaxSections> sections;
+        std::array<int, MaxSections> enabledSections {};    //The indices of the sections that are on, in cascade order
+        int enabledCount = 0;
+
+        static constexpr int CASCADE_CHUNK = 64;
+
+        alignas(sizeof(SIMDDouble)) std::array<double, CASCADE_CHUNK * DOUBLE_LANES> frames {};    //One chunk of both channels, interleaved
+        std::array<SIMDDouble, MaxSections> stageOutputs;   //What each enabled section produced in the previous step, the next one's input
+
+        Section& getEnabledSection(int index) noexcept { return sections[(size_t)enabledSections[(size_t)index]]; }
+
+        /// @brief Runs the frames through the enabled sections.
+        /// Run one frame at a time, every section waits for the one before it, so the sections are skewed instead: in each step section i filters the frame i places behind the first one's.
+        /// The sections of a step don't depend on each other, so their latencies overlap. The first and last steps only run the sections that have a frame to work on
+        void filterFrames(int numFrames) noexcept
+        {
+            const int last = enabledCount - 1;
+
+            const int steadyEnd = juce::jmax(last, numFrames);
+
+            for(int step = 0; step < last; step++)
+                runSkewedStep(step, juce::jmax(0, step - numFrames + 1), step);
+
+            runSkewedSteps(last, steadyEnd);
+
+            for(int step = steadyEnd; step < numFrames + last; step++)
+                runSkewedStep(step, juce::jmax(0, step - numFrames + 1), last);
+        }
+
+        /// @brief Runs the given sections for one step, from the highest down, so each one reads what the one before it produced in the previous step
+        void runSkewedStep(int step, int lowest, int highest) noexcept
+        {
+            const int last = enabledCount - 1;
+            for(int i = highest; i >= lowest; i--)
+            {
+                auto& section = getEnabledSection(i);
+                const auto x = i == 0 ? SIMDDouble::fromRawArray(frames.data() + step * DOUBLE_LANES) : stageOutputs[(size_t)i - 1];
+                const auto y = x * section.b0 + section.s1;
+                section.s1 = x * section.b1 - y * section.a1 + section.s2;
+                section.s2 = x * section.b2 - y * section.a2;
+
+                if( i == last )
+                    y.copyToRawArray(frames.data() + ( step - last ) * DOUBLE_LANES);
+                else
+                    stageOutputs[(size_t)i] = y;
+            }
+        }
+
+        /// @brief Runs the steps in which every section has a frame. The section count is made a compile time constant, so the loop over the sections unrolls and their states stay in registers
+        void runSkewedSteps(int begin, int end) noexcept
+        {
+            [&]<size_t... Counts>(std::index_sequence<Counts...>)
+            {
+                ( ( enabledCount == (int)Counts + 1 ? runSkewedSteps<(int)Counts + 1>(begin, end) : void() ), ... );
+            }(std::make_index_sequence<MaxSections>());
+        }
+
+        template <int Count>
+        void runSkewedSteps(int begin, int end) noexcept
+        {
+            std::array<Section*, Count> active;
+            std::array<SIMDDouble, Count> s1, s2, inputs;
+            for(int i = 0; i < Count; i++)
+            {
+                active[(size_t)i] = &getEnabledSection(i);
+                s1[(size_t)i] = active[(size_t)i]->s1;
+                s2[(size_t)i] = active[(size_t)i]->s2;
+                inputs[(size_t)i] = i == 0 ? SIMDDouble::expand(0.0) : stageOutputs[(size_t)i - 1];
+            }
+
+            for(int step = begin; step < end; step++)
+            {
+                inputs[0] = SIMDDouble::fromRawArray(frames.data() + step * DOUBLE_LANES);
+
+               #if JUCE_GCC || JUCE_CLANG
+                #pragma GCC unroll 16
+               #endif
+                for(int i = Count - 1; i >= 0; i--)
+                {
+                    const auto& section = *active[(size_t)i];
+                    const auto x = inputs[(size_t)i];
+                    const auto y = x * section.b0 + s1[(size_t)i];
+                    s1[(size_t)i] = x * section.b1 - y * section.a1 + s2[(size_t)i];
+                    s2[(size_t)i] = x * section.b2 - y * section.a2;
+
+                    if( i == Count - 1 )
+                        y.copyToRawArray(frames.data() + ( step - ( Count - 1 ) ) * DOUBLE_LANES);
+                    else
+                        inputs[(size_t)i + 1] = y;
+                }
+            }
+
+            for(int i = 0; i < Count; i++)
+            {
+                active[(size_t)i]->s1 = s1[(size_t)i];
+                active[(size_t)i]->s2 = s2[(size_t)i];
+                if( i > 0 )
+                    stageOutputs[(size_t)i - 1] = inputs[(size_t)i];
+            }
+        }
+
+        void updateEnabledSections() noexcept
+        {
+            enabledCount = 0;
+            for(int i = 0; i < MaxSections; i++)
+            {
+                if( sections[(size_t)i].enabled )
+                    enabledSections[(size_t)enabledCount++] = i;
+            }
+        }
+    };
+}
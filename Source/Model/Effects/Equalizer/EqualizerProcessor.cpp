@@ -9,123 +9,60 @@
 */
 
 #include "EqualizerProcessor.h"
+#include "../../ParameterSnapshot.h"
 
 #include "../../../View/Effects/Equalizer/EqualizerEditor.h"
 
 namespace Processor::Effects::Equalizer
 {
-    EqualizerProcessor::EqualizerProcessor(juce::AudioProcessorValueTreeState& apvts) : apvts(apvts)
-    {
-        for(int i = 0; i < 2; i++)
-        {
-            equalizers.add(std::make_unique<juce::OwnedArray<Filter>>());
-            for(int j = 0; j < NUM_BANDS; j++)
-            {
-                equalizers[i]->add(std::make_unique<Filter>());
-            }
-        }
-        
-        registerListener(this);
-    }
-
-    EqualizerProcessor::~EqualizerProcessor() 
-    {
-        removeListener(this);
-    }
+    EqualizerProcessor::EqualizerProcessor(juce::AudioProcessorValueTreeState& apvts) : apvts(apvts) {}
 
     void EqualizerProcessor::prepareToPlay(double sampleRate, int samplesPerBlock) 
     {
         setPlayConfigDetails(getMainBusNumInputChannels(), getMainBusNumOutputChannels(), sampleRate, samplesPerBlock);
-        
-        juce::dsp::ProcessSpec processSpec;
-        processSpec.maximumBlockSize = samplesPerBlock;
-        processSpec.numChannels = 1;
-        processSpec.sampleRate = sampleRate;
 
-        for(auto equalizer : equalizers)
-        {
-            for(auto filter : *equalizer)
-            {
-                filter->prepare(processSpec);
-            }
-        }
-
-        for(auto equalizer : equalizers)
-        {
-            for(int i = 0; i < NUM_BANDS; i++)
-            {
-                float gain = apvts.getRawParameterValue(getBandGainParameterID(i))->load();
-                updateBand(*(*equalizer)[i], getFrequency(i), proportionalQ(gain, Q_SCALE), juce::Decibels::decibelsToGain(gain));
-            }
-        }
+        bands.reset();
+        parametersApplied = false;
     }
 
     void EqualizerProcessor::processBlock(juce::AudioBuffer<float> &buffer, juce::MidiBuffer &midiMessages) 
-    {
-        juce::dsp::AudioBlock<float> audioBlock(buffer);
-
-        for(size_t channel = 0; channel < buffer.getNumChannels(); channel++)
-        {
-            auto singleBlock = audioBlock.getSingleChannelBlock(channel);
-            juce::dsp::ProcessContextReplacing<float> singleContext(singleBlock);
+    {   //Both channels go through every band in one pass per sample
+        float* left = buffer.getWritePointer(0);
+        float* right = buffer.getNumChannels() > 1 ? buffer.getWritePointer(1) : nullptr;
 
-            for(auto filter : *equalizers[channel])
-            {
-                filter->process(singleContext);
-            }
-        }
+        bands.process(left, right, buffer.getNumSamples());
     }
 
     void EqualizerProcessor::releaseResources() 
     {
-        for(auto equalizer : equalizers)
-        {
-            for(auto filter : *equalizer)
-            {
-                filter->reset();
-            }
-        }
+        bands.reset();
     }
 
-    void EqualizerProcessor::registerListener(juce::AudioProcessorValueTreeState::Listener* listener) const
-    {
-        auto paramLayoutSchema = createParameterLayout();
-        auto params = paramLayoutSchema->getParameters(false);
-
-        for(auto param : params)
+    void EqualizerProcessor::applyParameters(const ParameterSnapshot& parameters)
+    {   //Only the bands whose gain changed are recalculated
+        for(int i = 0; i < NUM_BANDS; i++)
         {
-            auto id = dynamic_cast<juce::RangedAudioParameter*>(param)->getParameterID();
-            apvts.addParameterListener(id, listener);
-        }
-    }
-
-    void EqualizerProcessor::removeListener(juce::AudioProcessorValueTreeState::Listener* listener) const
-    {
-        auto paramLayoutSchema = createParameterLayout();
-        auto params = paramLayoutSchema->getParameters(false);
+            const float gain = parameters.equalizer.bandGains[i];
+            if( parametersApplied && gain == appliedParameters.bandGains[i] )
+            {
+                continue;
+            }
 
-        for(auto param : params)
-        {
-            auto id = dynamic_cast<juce::RangedAudioParameter*>(param)->getParameterID();
-            apvts.removeParameterListener(id, listener);
+            appliedParameters.bandGains[i] = gain;
+            updateBand(i, gain);
         }
+        parametersApplied = true;
     }
 
-    void EqualizerProcessor::parameterChanged(const juce::String &parameterID, float newValue) 
+    void EqualizerProcessor::updateBand(const int index, const float gain)
     {
-        int index = getBandIndexFromParameterID(parameterID);
-        for(auto equalizer : equalizers)
-        {
-            float gain = apvts.getRawParameterValue(getBandGainParameterID(index))->load();
-
-            updateBand(*(*equalizer)[index], getFrequency(index), proportionalQ(gain, Q_SCALE), juce::Decibels::decibelsToGain(gain));
+        if( gain == 0.f )
+        {   //A peak filter at 0 dB passes the signal through unchanged
+            bands.disableSection(index);
+            return;
         }
-    }
 
-    void EqualizerProcessor::updateBand(Filter& band, const float frequency, const float q, const float gain)
-    {
-        auto newCoeffs = Coefficients::makePeakFilter(getSampleRate(), frequency, q, gain);
-        *band.coefficients = *newCoeffs;
+        bands.setSection(index, BiquadCoefficients::makePeak(getSampleRate(), getFrequency(index), proportionalQ(gain, Q_SCALE), juce::Decibels::decibelsToGain(gain)));
     }
 
     const float EqualizerProcessor::proportionalQ(const float gain, const float constant) const
@@ -139,6 +76,18 @@ namespace Processor::Effects::Equalizer
         return 31.25 * pow(2, index);
     }
 
+    double EqualizerProcessor::getTailLengthSeconds() const
+    {   //A band at 0 dB passes the signal through unchanged, the others ring like a resonance at their frequency and Q
+        double tail = 0.0;
+        for(int i = 0; i < NUM_BANDS; i++)
+        {
+            const float gain = appliedParameters.bandGains[i];
+            if( gain != 0.f )
+                tail = juce::jmax(tail, getResonanceTailSeconds(getFrequency(i), proportionalQ(gain, Q_SCALE)));
+        }
+        return tail;
+    }
+
     Editor::Effects::EffectEditor* EqualizerProcessor::createEditorUnit()
     {
         return new Editor::Effects::EqualizerEditor(apvts);
@@ -11,12 +11,10 @@
 #pragma once
 
 #include "../EffectProcessor.h"
+#include "BiquadKernel.h"
 
 namespace Processor::Effects::Equalizer
 {
-    using Filter = juce::dsp::IIR::Filter<float>;
-    using Coefficients = juce::dsp::IIR::Coefficients<float>;
-
     constexpr int NUM_BANDS = 10;
     constexpr float Q_SCALE = 0.25;
 
@@ -29,13 +27,6 @@ namespace Processor::Effects::Equalizer
         return "band" + juce::String(index) + "gain";
     }
 
-    static const int getBandIndexFromParameterID(const juce::String paramID)
-    {
-        int index = std::stoi(paramID.trimCharactersAtStart("band").trimCharactersAtEnd("gain").toStdString());
-        jassert(juce::isPositiveAndBelow(index, NUM_BANDS));
-        return index;
-    }
-
     /// @brief Used for getting usable frequency numbers from a bands' index
     /// @param index The index of the band
     /// @return A string containing the frequency the band is responsible for
@@ -56,6 +47,12 @@ namespace Processor::Effects::Equalizer
         return label + suffix;
     }
 
+    /// @brief The values of the equalizer's parameters for one block
+    struct alignas(64) EqualizerParameterValues
+    {
+        std::array<float, NUM_BANDS> bandGains {};
+    };
+
     static std::unique_ptr<juce::AudioProcessorParameterGroup> createParameterLayout()
     {
         std::unique_ptr<juce::AudioProcessorParameterGroup> eqGroup (
@@ -81,14 +78,13 @@ namespace Processor::Effects::Equalizer
     {
     public:
         EqualizerProcessor(juce::AudioProcessorValueTreeState& apvts);
-        ~EqualizerProcessor() override;
 
         void prepareToPlay(double sampleRate, int samplesPerBlock) override;
         void processBlock(juce::AudioBuffer<float> &buffer, juce::MidiBuffer &midiMessages) override;
         void releaseResources() override;
 
-        void registerListener(juce::AudioProcessorValueTreeState::Listener* listener) const;
-        void removeListener(juce::AudioProcessorValueTreeState::Listener* listener) const;
+        void applyParameters(const ParameterSnapshot& parameters) override;
+        double getTailLengthSeconds() const override;
 
         Editor::Effects::EffectEditor* createEditorUnit() override;
 
@@ -100,11 +96,13 @@ namespace Processor::Effects::Equalizer
     private:
         juce::AudioProcessorValueTreeState& apvts;
 
-        juce::OwnedArray<juce::OwnedArray<Filter>> equalizers;
-        
-        void parameterChanged(const juce::String &parameterID, float newValue) override;
+        BiquadCascade<NUM_BANDS> bands;                //Both channels in one cascade, the bands at 0 dB are switched off
+
+        EqualizerParameterValues appliedParameters;    //The values the effect was last updated to
+        bool parametersApplied = false;                //False until the first block after prepareToPlay, which applies every value
 
-        void updateBand(Filter& band, const float frequency, const float q, const float gain);
+        /// @brief Recalculates the band's coefficients, or switches the band off if its gain is 0 dB
+        void updateBand(const int index, const float gain);
 
         /// @brief Scales the peak filter's Q to it's gain.
         /// @param gain The gain level (dB) to use for scaling
@@ -9,6 +9,7 @@
 */
 
 #include "FilterProcessor.h"
+#include "../../ParameterSnapshot.h"
 
 #include "../../../View/Effects/Filter/FilterEditor.h"
 
@@ -19,12 +20,6 @@ namespace Processor::Effects::Filter
         filters.add(std::make_unique<PassFilter>());
         filters.add(std::make_unique<PassFilter>());
         dryWetMixer.setMixingRule(juce::dsp::DryWetMixingRule::linear);
-        registerListener(this);
-    }
-
-    FilterProcessor::~FilterProcessor() 
-    {
-        removeListener(this);
     }
 
     void FilterProcessor::prepareToPlay(double sampleRate, int samplesPerBlock) 
@@ -46,7 +41,7 @@ namespace Processor::Effects::Filter
         dryWetSpec.numChannels = getTotalNumOutputChannels();
         dryWetSpec.sampleRate = sampleRate;
         dryWetMixer.prepare(dryWetSpec);
-        updateFilterParameters();
+        parametersApplied = false;
     }
 
     void FilterProcessor::processBlock(juce::AudioBuffer<float> &buffer, juce::MidiBuffer &midiMessages) 
@@ -74,112 +69,78 @@ namespace Processor::Effects::Filter
         }
     }
 
-    void FilterProcessor::registerListener(juce::AudioProcessorValueTreeState::Listener* listener) const
+    void FilterProcessor::applyParameters(const ParameterSnapshot& parameters)
     {
-        auto paramLayoutSchema = createParameterLayout();
-        auto params = paramLayoutSchema->getParameters(false);
-
-        for(auto param : params)
+        if( parametersApplied && parameters.filter == appliedParameters )
         {
-            auto id = dynamic_cast<juce::RangedAudioParameter*>(param)->getParameterID();
-            apvts.addParameterListener(id, listener);
+            return;
         }
-    }
-
-    void FilterProcessor::removeListener(juce::AudioProcessorValueTreeState::Listener* listener) const
-    {
-        auto paramLayoutSchema = createParameterLayout();
-        auto params = paramLayoutSchema->getParameters(false);
 
-        for(auto param : params)
-        {
-            auto id = dynamic_cast<juce::RangedAudioParameter*>(param)->getParameterID();
-            apvts.removeParameterListener(id, listener);
-        }
-    }
-
-    void FilterProcessor::parameterChanged(const juce::String &parameterID, float newValue)
-    {
+        appliedParameters = parameters.filter;
+        parametersApplied = true;
         updateFilterParameters();
     }
-    
+
     void FilterProcessor::updateFilterParameters()
     {
         if(getSampleRate() > 0)
         {
-            dryWetMixer.setWetMixProportion(apvts.getRawParameterValue("filterMix")->load()/100); 
-            float frequency = apvts.getRawParameterValue("filterCutoff")->load();
+            dryWetMixer.setWetMixProportion(appliedParameters.mix/100);
+            float frequency = appliedParameters.cutoff;
 
-            juce::ReferenceCountedArray<Coefficients> coeffs;
-
-            FilterType type = static_cast<FilterType>(dynamic_cast<juce::AudioParameterChoice*>(apvts.getParameter("filterType"))->getIndex());
-            FilterSlope slope = static_cast<FilterSlope>(dynamic_cast<juce::AudioParameterChoice*>(apvts.getParameter("filterSlope"))->getIndex());
-
-            switch (type)
-            {
-                case Low_Pass:
-                    coeffs = makeLowPassCoefficients(frequency, slope);
-                    break;
-                case High_Pass:
-                    coeffs = makeHighPassCoefficients(frequency, slope);
-                    break;
-                default:
-                    return;
-            }
+            FilterType type = static_cast<FilterType>((int)appliedParameters.type);
+            FilterSlope slope = static_cast<FilterSlope>((int)appliedParameters.slope);
 
             for(auto filter : filters)
             {
-                filter->setBypassed<0>(true);
-                filter->setBypassed<1>(true);
-                
-                switch(slope)
-                {
-                    case s24dBOct:
-                    {
-                        updatePassFilter<1>(*filter, coeffs);
-                        updatePassFilter<0>(*filter, coeffs);
-                        break;
-                    }
-                    case s18dBOct:
-                    {
-                        updatePassFilter<1>(*filter, coeffs);
-                        updatePassFilter<0>(*filter, coeffs);
-                        break;
-                    }
-                    case s12dBOct:
-                    {
-                        updatePassFilter<0>(*filter, coeffs);
-                        break;
-                    }
-                    case s6dBOct:
-                    {
-                        updatePassFilter<0>(*filter, coeffs);
-                        break;
-                    }
-                    default:
-                        return;
-                }
+                updatePassFilter(*filter, type, frequency, slope + 1);
             }
         }
     }
 
-    juce::ReferenceCountedArray<Coefficients> FilterProcessor::makeLowPassCoefficients(float frequency, FilterSlope slope)
+    void FilterProcessor::updatePassFilter(PassFilter& filter, FilterType type, float frequency, int order)
     {
-        return FilterDesign::designIIRLowpassHighOrderButterworthMethod(frequency, getSampleRate(), slope+1);
-    }
+        filter.setBypassed<0>(true);
+        filter.setBypassed<1>(true);
 
-    juce::ReferenceCountedArray<Coefficients> FilterProcessor::makeHighPassCoefficients(float frequency, FilterSlope slope)
-    {
-        return FilterDesign::designIIRHighpassHighOrderButterworthMethod(frequency, getSampleRate(), slope+1);
+        //Same design as juce::dsp::FilterDesign's Butterworth method, but without allocating the coefficients
+        const auto sampleRate = getSampleRate();
+        int section = 0;
+
+        if( order % 2 == 1 )
+        {
+            updatePassFilterSection<0>(filter, type == Low_Pass ? ArrayCoefficients::makeFirstOrderLowPass(sampleRate, frequency)
+                                                                : ArrayCoefficients::makeFirstOrderHighPass(sampleRate, frequency));
+            section++;
+        }
+
+        for(int i = 0; i < order / 2; i++, section++)
+        {
+            const double angle = order % 2 == 1 ? ( i + 1.0 ) * juce::MathConstants<double>::pi / order
+                                                : ( 2.0 * i + 1.0 ) * juce::MathConstants<double>::pi / ( order * 2.0 );
+            const float q = (float)( 1.0 / ( 2.0 * std::cos(angle) ) );
+
+            const auto coefficients = type == Low_Pass ? ArrayCoefficients::makeLowPass(sampleRate, frequency, q)
+                                                       : ArrayCoefficients::makeHighPass(sampleRate, frequency, q);
+            if( section == 0 )
+                updatePassFilterSection<0>(filter, coefficients);
+            else
+                updatePassFilterSection<1>(filter, coefficients);
+        }
     }
 
-    template<int Index>
-    void FilterProcessor::updatePassFilter(PassFilter& filter, const juce::ReferenceCountedArray<Coefficients>& coefficients)
+    template<int Index, size_t Size>
+    void FilterProcessor::updatePassFilterSection(PassFilter& filter, const std::array<float, Size>& coefficients)
     {
-        *(filter.get<Index>().coefficients) = *(coefficients[Index]);
+        *(filter.get<Index>().coefficients) = coefficients;
         filter.setBypassed<Index>(false);
     }
 
+    double FilterProcessor::getTailLengthSeconds() const
+    {   //The steepest slope has the most resonant Butterworth section, with a Q of 1.31
+        return getResonanceTailSeconds(appliedParameters.cutoff, 1.31);
+    }
+
     Editor::Effects::EffectEditor* FilterProcessor::createEditorUnit()
     {
         return new Editor::Effects::FilterEditor(apvts);
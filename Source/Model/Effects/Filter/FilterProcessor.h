@@ -16,7 +16,7 @@ namespace Processor::Effects::Filter
 {
     using Filter = juce::dsp::IIR::Filter<float>;
     using Coefficients = juce::dsp::IIR::Coefficients<float>;
-    using FilterDesign = juce::dsp::FilterDesign<float>;
+    using ArrayCoefficients = juce::dsp::IIR::ArrayCoefficients<float>;
     using PassFilter = juce::dsp::ProcessorChain<Filter, Filter>;
     using DryWetMixer = juce::dsp::DryWetMixer<float>;
 
@@ -37,6 +37,17 @@ namespace Processor::Effects::Filter
     static const juce::StringArray filterTypeChoices = {"Low-pass", "High-pass"};
     static const juce::StringArray filterSlopeChoices = {"6dB/Oct", "12dB/Oct", "18dB/Oct", "24dB/Oct"};
     
+    /// @brief The values of the filter's parameters for one block
+    struct alignas(64) FilterParameterValues
+    {
+        float mix = 0.f;
+        float type = 0.f;
+        float slope = 0.f;
+        float cutoff = 0.f;
+
+        bool operator==(const FilterParameterValues&) const = default;
+    };
+
     static std::unique_ptr<juce::AudioProcessorParameterGroup> createParameterLayout()
     {
         std::unique_ptr<juce::AudioProcessorParameterGroup> filterGroup (
@@ -77,14 +88,13 @@ namespace Processor::Effects::Filter
     {
     public:
         FilterProcessor(juce::AudioProcessorValueTreeState& apvts);
-        ~FilterProcessor() override;
 
         void prepareToPlay(double sampleRate, int samplesPerBlock) override;
         void processBlock(juce::AudioBuffer<float> &buffer, juce::MidiBuffer &midiMessages) override;
         void releaseResources() override;
 
-        void registerListener(juce::AudioProcessorValueTreeState::Listener* listener) const;
-        void removeListener(juce::AudioProcessorValueTreeState::Listener* listener) const;
+        void applyParameters(const ParameterSnapshot& parameters) override;
+        double getTailLengthSeconds() const override;
 
         Editor::Effects::EffectEditor* createEditorUnit() override;
 
@@ -99,15 +109,16 @@ namespace Processor::Effects::Filter
         juce::OwnedArray<PassFilter> filters;
         DryWetMixer dryWetMixer;
 
-        void parameterChanged(const juce::String &parameterID, float newValue) override;
+        FilterParameterValues appliedParameters;    //The values the effect was last updated to
+        bool parametersApplied = false;             //False until the first block after prepareToPlay, which applies every value
 
         void updateFilterParameters();
 
-        juce::ReferenceCountedArray<Coefficients> makeLowPassCoefficients(float frequency, FilterSlope slope);
-        juce::ReferenceCountedArray<Coefficients> makeHighPassCoefficients(float frequency, FilterSlope slope);
+        /// @brief Designs the Butterworth response of the given order as a cascade of at most two sections, and writes it into the filter's existing coefficients
+        void updatePassFilter(PassFilter& filter, FilterType type, float frequency, int order);
 
-        template<int Index>
-        void updatePassFilter(PassFilter& filter, const juce::ReferenceCountedArray<Coefficients>& coefficients);
+        template<int Index, size_t Size>
+        void updatePassFilterSection(PassFilter& filter, const std::array<float, Size>& coefficients);
 
         JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(FilterProcessor);
     };
@@ -9,20 +9,14 @@
 */
 
 #include "PhaserProcessor.h"
+#include "../../ParameterSnapshot.h"
 
 #include "../../../View/Effects/Phaser/PhaserEditor.h"
 
 namespace Processor::Effects::Phaser
 {
     PhaserProcessor::PhaserProcessor(juce::AudioProcessorValueTreeState& apvts) : apvts(apvts)
-    {
-        registerListener(this);
-    }
-
-    PhaserProcessor::~PhaserProcessor() 
-    {
-        removeListener(this);
-    }
+    {}
 
     void PhaserProcessor::prepareToPlay(double sampleRate, int samplesPerBlock) 
     {
@@ -33,7 +27,7 @@ namespace Processor::Effects::Phaser
         processSpec.numChannels = getTotalNumOutputChannels();
         processSpec.sampleRate = sampleRate;
         phaser.prepare(processSpec);
-        updatePhaserParameters();
+        parametersApplied = false;
     }
 
     void PhaserProcessor::processBlock(juce::AudioBuffer<float> &buffer, juce::MidiBuffer &midiMessages) 
@@ -50,44 +44,32 @@ namespace Processor::Effects::Phaser
         phaser.reset();
     }
 
-    void PhaserProcessor::registerListener(juce::AudioProcessorValueTreeState::Listener* listener) const
+    void PhaserProcessor::applyParameters(const ParameterSnapshot& parameters)
     {
-        auto paramLayoutSchema = createParameterLayout();
-        auto params = paramLayoutSchema->getParameters(false);
-
-        for(auto param : params)
+        if( parametersApplied && parameters.phaser == appliedParameters )
         {
-            auto id = dynamic_cast<juce::RangedAudioParameter*>(param)->getParameterID();
-            apvts.addParameterListener(id, listener);
+            return;
         }
-    }
 
-    void PhaserProcessor::removeListener(juce::AudioProcessorValueTreeState::Listener* listener) const
-    {
-        auto paramLayoutSchema = createParameterLayout();
-        auto params = paramLayoutSchema->getParameters(false);
-
-        for(auto param : params)
-        {
-            auto id = dynamic_cast<juce::RangedAudioParameter*>(param)->getParameterID();
-            apvts.removeParameterListener(id, listener);
-        }
+        appliedParameters = parameters.phaser;
+        parametersApplied = true;
+        updatePhaserParameters();
     }
 
     void PhaserProcessor::updatePhaserParameters()
     {
-        phaser.setMix(apvts.getRawParameterValue("phaserMix")->load()/100);
-        phaser.setRate(apvts.getRawParameterValue("phaserRate")->load());
-        phaser.setDepth(apvts.getRawParameterValue("phaserDepth")->load()/100);
-        phaser.setCentreFrequency(apvts.getRawParameterValue("phaserFrequency")->load());
-        phaser.setFeedback(apvts.getRawParameterValue("phaserFeedback")->load()/100);
+        phaser.setMix(appliedParameters.mix/100);
+        phaser.setRate(appliedParameters.rate);
+        phaser.setDepth(appliedParameters.depth/100);
+        phaser.setCentreFrequency(appliedParameters.frequency);
+        phaser.setFeedback(appliedParameters.feedback/100);
     }
 
-    void PhaserProcessor::parameterChanged(const juce::String &parameterID, float newValue) 
-    {
-        updatePhaserParameters();
+    double PhaserProcessor::getTailLengthSeconds() const
+    {   //juce::dsp::Phaser has six first order allpasses, each delaying low frequencies by 1 / (pi * f). Half the centre frequency leaves room for the sweep
+        return getFeedbackTailSeconds(6.0 / ( juce::MathConstants<double>::pi * 0.5 * appliedParameters.frequency ), appliedParameters.feedback / 100);
     }
-    
+
     Editor::Effects::EffectEditor* PhaserProcessor::createEditorUnit()
     {
         return new Editor::Effects::PhaserEditor(apvts);
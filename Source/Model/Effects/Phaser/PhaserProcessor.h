@@ -16,6 +16,18 @@ namespace Processor::Effects::Phaser
 {
     using Phaser = juce::dsp::Phaser<float>;
 
+    /// @brief The values of the phaser's parameters for one block
+    struct alignas(64) PhaserParameterValues
+    {
+        float mix = 0.f;
+        float rate = 0.f;
+        float depth = 0.f;
+        float frequency = 0.f;
+        float feedback = 0.f;
+
+        bool operator==(const PhaserParameterValues&) const = default;
+    };
+
     static std::unique_ptr<juce::AudioProcessorParameterGroup> createParameterLayout()
     {
         std::unique_ptr<juce::AudioProcessorParameterGroup> phaserGroup (
@@ -66,14 +78,13 @@ namespace Processor::Effects::Phaser
     {
     public:
         PhaserProcessor(juce::AudioProcessorValueTreeState& apvts);
-        ~PhaserProcessor() override;
 
         void prepareToPlay(double sampleRate, int samplesPerBlock) override;
         void processBlock(juce::AudioBuffer<float> &buffer, juce::MidiBuffer &midiMessages) override;
         void releaseResources() override;
 
-        void registerListener(juce::AudioProcessorValueTreeState::Listener* listener) const;
-        void removeListener(juce::AudioProcessorValueTreeState::Listener* listener) const;
+        void applyParameters(const ParameterSnapshot& parameters) override;
+        double getTailLengthSeconds() const override;
         
         Editor::Effects::EffectEditor* createEditorUnit() override;
 
@@ -87,7 +98,8 @@ namespace Processor::Effects::Phaser
         
         Phaser phaser;
 
-        void parameterChanged(const juce::String &parameterID, float newValue) override;
+        PhaserParameterValues appliedParameters;    //The values the effect was last updated to
+        bool parametersApplied = false;             //False until the first block after prepareToPlay, which applies every value
 
         void updatePhaserParameters();
 
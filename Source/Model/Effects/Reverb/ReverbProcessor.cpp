@@ -9,20 +9,14 @@
 */
 
 #include "ReverbProcessor.h"
+#include "../../ParameterSnapshot.h"
 
 #include "../../../View/Effects/Reverb/ReverbEditor.h"
 
 namespace Processor::Effects::Reverb
 {
     ReverbProcessor::ReverbProcessor(juce::AudioProcessorValueTreeState& apvts) : apvts(apvts)
-    {
-        registerListener(this);
-    }
-
-    ReverbProcessor::~ReverbProcessor() 
-    {
-        removeListener(this);
-    }
+    {}
 
     void ReverbProcessor::prepareToPlay(double sampleRate, int samplesPerBlock) 
     {
@@ -33,7 +27,7 @@ namespace Processor::Effects::Reverb
         processSpec.numChannels = getTotalNumOutputChannels();
         processSpec.sampleRate = sampleRate;
         reverb.prepare(processSpec);
-        updateReverbParameters();
+        parametersApplied = false;
     }
 
     void ReverbProcessor::processBlock(juce::AudioBuffer<float> &buffer, juce::MidiBuffer &midiMessages) 
@@ -50,46 +44,34 @@ namespace Processor::Effects::Reverb
         reverb.reset();
     }
 
-    void ReverbProcessor::registerListener(juce::AudioProcessorValueTreeState::Listener* listener) const
+    void ReverbProcessor::applyParameters(const ParameterSnapshot& parameters)
     {
-        auto paramLayoutSchema = createParameterLayout();
-        auto params = paramLayoutSchema->getParameters(false);
-
-        for(auto param : params)
+        if( parametersApplied && parameters.reverb == appliedParameters )
         {
-            auto id = dynamic_cast<juce::RangedAudioParameter*>(param)->getParameterID();
-            apvts.addParameterListener(id, listener);
+            return;
         }
-    }
 
-    void ReverbProcessor::removeListener(juce::AudioProcessorValueTreeState::Listener* listener) const
-    {
-        auto paramLayoutSchema = createParameterLayout();
-        auto params = paramLayoutSchema->getParameters(false);
-
-        for(auto param : params)
-        {
-            auto id = dynamic_cast<juce::RangedAudioParameter*>(param)->getParameterID();
-            apvts.removeParameterListener(id, listener);
-        }
+        appliedParameters = parameters.reverb;
+        parametersApplied = true;
+        updateReverbParameters();
     }
 
     void ReverbProcessor::updateReverbParameters()
     {
         Reverb::Parameters newParams;
-        newParams.wetLevel = apvts.getRawParameterValue("reverbWet")->load()/100;
-        newParams.dryLevel = apvts.getRawParameterValue("reverbDry")->load()/100;
-        newParams.roomSize = apvts.getRawParameterValue("reverbRoom")->load()/100;
-        newParams.damping = apvts.getRawParameterValue("reverbDamping")->load()/100;
-        newParams.width = apvts.getRawParameterValue("reverbWidth")->load()/100;
+        newParams.wetLevel = appliedParameters.wet/100;
+        newParams.dryLevel = appliedParameters.dry/100;
+        newParams.roomSize = appliedParameters.room/100;
+        newParams.damping = appliedParameters.damping/100;
+        newParams.width = appliedParameters.width/100;
         reverb.setParameters(newParams);
     }        
-    
-    void ReverbProcessor::parameterChanged(const juce::String &parameterID, float newValue) 
-    {
-        updateReverbParameters();
+
+    double ReverbProcessor::getTailLengthSeconds() const
+    {   //juce::dsp::Reverb is a Freeverb, whose comb filters feed back with 0.7 + 0.28 * room size. The longest comb is 1617 samples and the allpasses add 1563, both at 44.1 kHz
+        return getFeedbackTailSeconds(1617.0 / 44100.0, 0.7 + 0.28 * appliedParameters.room / 100) + 1563.0 / 44100.0;
     }
-    
+
     Editor::Effects::EffectEditor* ReverbProcessor::createEditorUnit()
     {
         return new Editor::Effects::ReverbEditor(apvts);
@@ -16,6 +16,18 @@ namespace Processor::Effects::Reverb
 {
     using Reverb = juce::dsp::Reverb;
 
+    /// @brief The values of the reverb's parameters for one block
+    struct alignas(64) ReverbParameterValues
+    {
+        float wet = 0.f;
+        float dry = 0.f;
+        float room = 0.f;
+        float damping = 0.f;
+        float width = 0.f;
+
+        bool operator==(const ReverbParameterValues&) const = default;
+    };
+
     static std::unique_ptr<juce::AudioProcessorParameterGroup> createParameterLayout()
     {
         std::unique_ptr<juce::AudioProcessorParameterGroup> reverbGroup (
@@ -66,14 +78,13 @@ namespace Processor::Effects::Reverb
     {
     public:
         ReverbProcessor(juce::AudioProcessorValueTreeState& apvts);
-        ~ReverbProcessor() override;
 
         void prepareToPlay(double sampleRate, int samplesPerBlock) override;
         void processBlock(juce::AudioBuffer<float> &buffer, juce::MidiBuffer &midiMessages) override;
         void releaseResources() override;
 
-        void registerListener(juce::AudioProcessorValueTreeState::Listener* listener) const;
-        void removeListener(juce::AudioProcessorValueTreeState::Listener* listener) const;
+        void applyParameters(const ParameterSnapshot& parameters) override;
+        double getTailLengthSeconds() const override;
         
         Editor::Effects::EffectEditor* createEditorUnit() override;
 
@@ -87,7 +98,8 @@ namespace Processor::Effects::Reverb
         
         Reverb reverb;
 
-        void parameterChanged(const juce::String &parameterID, float newValue) override;
+        ReverbParameterValues appliedParameters;    //The values the effect was last updated to
+        bool parametersApplied = false;             //False until the first block after prepareToPlay, which applies every value
 
         void updateReverbParameters();     
 
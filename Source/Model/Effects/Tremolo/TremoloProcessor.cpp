@@ -9,20 +9,14 @@
 */
 
 #include "TremoloProcessor.h"
+#include "../../ParameterSnapshot.h"
 
 #include "../../../View/Effects/Tremolo/TremoloEditor.h"
 
 namespace Processor::Effects::Tremolo
 {
     TremoloProcessor::TremoloProcessor(juce::AudioProcessorValueTreeState& apvts) : apvts(apvts)
-    {
-        registerListener(this);
-    }
-
-    TremoloProcessor::~TremoloProcessor() 
-    {
-        removeListener(this);
-    }
+    {}
 
     void TremoloProcessor::prepareToPlay(double sampleRate, int samplesPerBlock) 
     {
@@ -32,7 +26,7 @@ namespace Processor::Effects::Tremolo
         processSpec.maximumBlockSize = samplesPerBlock;
         processSpec.numChannels = getMainBusNumOutputChannels();
         processSpec.sampleRate = sampleRate;
-        updateTremoloParameters();
+        parametersApplied = false;
     }
 
     void TremoloProcessor::processBlock(juce::AudioBuffer<float> &buffer, juce::MidiBuffer &midiMessages) 
@@ -70,41 +64,24 @@ namespace Processor::Effects::Tremolo
         currentAngle = 0.f;
         angleDelta = 0.f;
     }
-    
-    void TremoloProcessor::registerListener(juce::AudioProcessorValueTreeState::Listener* listener) const
-    {
-        auto paramLayoutSchema = createParameterLayout();
-        auto params = paramLayoutSchema->getParameters(false);
 
-        for(auto param : params)
-        {
-            auto id = dynamic_cast<juce::RangedAudioParameter*>(param)->getParameterID();
-            apvts.addParameterListener(id, listener);
-        }
-    }
-
-    void TremoloProcessor::removeListener(juce::AudioProcessorValueTreeState::Listener* listener) const
+    void TremoloProcessor::applyParameters(const ParameterSnapshot& parameters)
     {
-        auto paramLayoutSchema = createParameterLayout();
-        auto params = paramLayoutSchema->getParameters(false);
-
-        for(auto param : params)
+        if( parametersApplied && parameters.tremolo == appliedParameters )
         {
-            auto id = dynamic_cast<juce::RangedAudioParameter*>(param)->getParameterID();
-            apvts.removeParameterListener(id, listener);
+            return;
         }
-    }
 
-    void TremoloProcessor::parameterChanged(const juce::String &parameterID, float newValue) 
-    {
+        appliedParameters = parameters.tremolo;
+        parametersApplied = true;
         updateTremoloParameters();
     }
-    
+
     void TremoloProcessor::updateTremoloParameters()
     {
-        depth = apvts.getRawParameterValue("tremoloDepth")->load()/100;
-        rate = apvts.getRawParameterValue("tremoloRate")->load();
-        isAutoPan = apvts.getRawParameterValue("tremoloAutoPan")->load();
+        depth = appliedParameters.depth/100;
+        rate = appliedParameters.rate;
+        isAutoPan = appliedParameters.autoPan > 0.5f;
         
         if(getSampleRate() > 0)
         {
@@ -14,6 +14,16 @@
 
 namespace Processor::Effects::Tremolo
 {
+    /// @brief The values of the tremolo's parameters for one block
+    struct alignas(64) TremoloParameterValues
+    {
+        float depth = 0.f;
+        float rate = 0.f;
+        float autoPan = 0.f;
+
+        bool operator==(const TremoloParameterValues&) const = default;
+    };
+
     static std::unique_ptr<juce::AudioProcessorParameterGroup> createParameterLayout()
     {
         std::unique_ptr<juce::AudioProcessorParameterGroup> tremoloGroup (
@@ -49,14 +59,12 @@ namespace Processor::Effects::Tremolo
     {
     public:
         TremoloProcessor(juce::AudioProcessorValueTreeState& apvts);
-        ~TremoloProcessor() override;
 
         void prepareToPlay(double sampleRate, int samplesPerBlock) override;
         void processBlock(juce::AudioBuffer<float> &buffer, juce::MidiBuffer &midiMessages) override;
         void releaseResources() override;
         
-        void registerListener(juce::AudioProcessorValueTreeState::Listener* listener) const;
-        void removeListener(juce::AudioProcessorValueTreeState::Listener* listener) const;
+        void applyParameters(const ParameterSnapshot& parameters) override;
         
         Editor::Effects::EffectEditor* createEditorUnit() override;
 
@@ -68,14 +76,15 @@ namespace Processor::Effects::Tremolo
     private:
         juce::AudioProcessorValueTreeState& apvts;
 
-        std::atomic<float> depth = 0;
-        std::atomic<float> rate = 0;
-        std::atomic<bool> isAutoPan = false;
+        float depth = 0;
+        float rate = 0;
+        bool isAutoPan = false;
 
         double currentAngle = 0;
         double angleDelta = 0;
 
-        void parameterChanged(const juce::String &parameterID, float newValue) override;
+        TremoloParameterValues appliedParameters;    //The values the effect was last updated to
+        bool parametersApplied = false;              //False until the first block after prepareToPlay, which applies every value
 
         void updateTremoloParameters();
 
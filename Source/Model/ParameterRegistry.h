@@ -0,0 +1,241 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "Synthesizer/Wavetable.h"
+#include "Effects/EffectProcessorChain.h"
+
+//Every parameter with a fixed id. The enum names are the ids themselves, so the two can't get out of sync
+#define VST_SYNTH_NAMED_PARAMETERS(X) \
+    X(synthGain) X(oscillatorOctaves) X(oscillatorSemitones) X(oscillatorFine) X(pitchWheelRange) \
+    X(globalPhase) X(randomPhaseRange) X(unisonCount) X(unisonDetune) X(unisonGain) \
+    X(amplitudeADSRAttack) X(amplitudeADSRDecay) X(amplitudeADSRSustain) X(amplitudeADSRRelease) \
+    X(partialEngine) X(partialDecay) X(partialDecayTilt) X(partialSustain) \
+    X(filterMix) X(filterType) X(filterSlope) X(filterCutoff) \
+    X(compressorMix) X(compressorThreshold) X(compressorRatio) X(compressorAttack) X(compressorRelease) \
+    X(delayMix) X(delayFeedback) X(delayTime) X(delayFilterFrequency) X(delayFilterQ) \
+    X(reverbWet) X(reverbDry) X(reverbRoom) X(reverbDamping) X(reverbWidth) \
+    X(chorusMix) X(chorusRate) X(chorusDelay) X(chorusDepth) X(chorusFeedback) \
+    X(phaserMix) X(phaserRate) X(phaserDepth) X(phaserFrequency) X(phaserFeedback) \
+    X(tremoloDepth) X(tremoloRate) X(tremoloAutoPan)
+
+namespace Processor
+{
+    /// @brief The dense index of every parameter of the plugin. Parameters that come in arrays take a contiguous range starting at their first index
+    namespace ParameterIndex
+    {
+        enum : int
+        {
+        #define VST_SYNTH_PARAMETER_INDEX(name) name,
+            VST_SYNTH_NAMED_PARAMETERS(VST_SYNTH_PARAMETER_INDEX)
+        #undef VST_SYNTH_PARAMETER_INDEX
+
+            namedCount,
+
+            partialGain = namedCount,                                           //One per harmonic
+            partialPhase = partialGain + Synthesizer::HARMONIC_N,               //One per harmonic
+            eqBandGain = partialPhase + Synthesizer::HARMONIC_N,                //One per band
+            fxBypass = eqBandGain + Effects::Equalizer::NUM_BANDS,              //One per effect slot
+            fxChoice = fxBypass + Effects::EffectsChain::FX_MAX_SLOTS,          //One per effect slot
+
+            count = fxChoice + Effects::EffectsChain::FX_MAX_SLOTS
+        };
+    }
+
+    constexpr int MAX_REGISTRY_LISTENERS = 8;
+
+    /// @brief Holds the current value of every parameter in one flat array, indexed by ParameterIndex.
+    /// Changes are dispatched from the host's parameter index with a table lookup, no string is hashed or compared after construction.
+    /// The listeners form a fixed table that is filled while the plugin is constructed and never changes after that, so dispatching takes no lock
+    class ParameterRegistry : private juce::AudioProcessorParameter::Listener
+    {
+    public:
+        using Callback = std::function<void(int parameterIndex, float newValue)>;
+
+        ParameterRegistry(juce::AudioProcessorValueTreeState& apvts) : processor(apvts.processor)
+        {
+            const auto& indexOfID = getParameterIndexTable();
+
+            auto& hostParameters = processor.getParameters();
+            hostToRegistry.resize((size_t)hostParameters.size(), -1);
+
+            for(auto* hostParameter : hostParameters)
+            {
+                auto* parameter = dynamic_cast<juce::RangedAudioParameter*>(hostParameter);
+                auto entry = indexOfID.find(parameter->getParameterID());
+                if( entry == indexOfID.end() )
+                {
+                    jassertfalse;   //Every parameter of the layout needs an index
+                    continue;
+                }
+
+                const int index = entry->second;
+                hostToRegistry[(size_t)parameter->getParameterIndex()] = index;
+                parameters[index] = parameter;
+                values[index].store(parameter->convertFrom0to1(parameter->getValue()));
+
+                parameter->addListener(this);
+            }
+        }
+
+        ~ParameterRegistry() override
+        {
+            for(auto* parameter : parameters)
+            {
+                if( parameter != nullptr )
+                    parameter->removeListener(this);
+            }
+        }
+
+        /// @return The current value of the parameter, in the parameter's own range
+        float get(int parameterIndex) const
+        {
+            return values[parameterIndex].load(std::memory_order_relaxed);
+        }
+
+        const std::atomic<float>& operator[](int parameterIndex) const
+        {
+            return values[parameterIndex];
+        }
+
+        juce::RangedAudioParameter* getParameter(int parameterIndex) const
+        {
+            return parameters[parameterIndex];
+        }
+
+        /// @brief Calls the callback after every change of a parameter in [firstIndex, endIndex), on the thread the change happened on.
+        /// Only called while the plugin is constructed, before the host or the editor can change a parameter
+        /// @param owner Identifies the callback for removeListener
+        void addListener(const void* owner, int firstIndex, int endIndex, Callback callback)
+        {
+            const int index = numListeners.load(std::memory_order_relaxed);
+            jassert(index < MAX_REGISTRY_LISTENERS);
+
+            if( index < MAX_REGISTRY_LISTENERS )
+            {
+                auto& listener = listeners[(size_t)index];
+                listener.owner = owner;
+                listener.firstIndex = firstIndex;
+                listener.endIndex = endIndex;
+                listener.callback = std::move(callback);
+                listener.active.store(true, std::memory_order_relaxed);
+
+                numListeners.store(index + 1, std::memory_order_release);
+            }
+        }
+
+        /// @brief Stops calling the callbacks of the given owner. Their entries stay in the table, so the owner has to be destroyed before anything could still change a parameter
+        void removeListener(const void* owner)
+        {
+            for(int i = 0; i < numListeners.load(std::memory_order_acquire); i++)
+            {
+                if( listeners[(size_t)i].owner == owner )
+                    listeners[(size_t)i].active.store(false, std::memory_order_release);
+            }
+        }
+
+        /// @return The id the parameter with the given index has in the value tree
+        static const juce::String& getParameterID(int parameterIndex)
+        {
+            jassert(juce::isPositiveAndBelow(parameterIndex, (int)ParameterIndex::count));
+            return getParameterIDTable()[(size_t)parameterIndex];
+        }
+
+        /// @brief The ids of every parameter, by index. Each parameter group is a contiguous range of it.
+        /// Built on first use and shared by every instance of the plugin in the process
+        static const std::array<juce::String, ParameterIndex::count>& getParameterIDTable()
+        {
+            static const auto table = []
+            {
+                std::array<juce::String, ParameterIndex::count> ids;
+                for(int i = 0; i < ParameterIndex::count; i++)
+                {
+                    ids[(size_t)i] = makeParameterID(i);
+                }
+                return ids;
+            }();
+            return table;
+        }
+
+    private:
+        struct ListenerEntry
+        {
+            const void* owner = nullptr;
+            int firstIndex = 0;
+            int endIndex = 0;
+            Callback callback;
+            std::atomic<bool> active { false };
+        };
+
+        juce::AudioProcessor& processor;
+
+        alignas(64) std::array<std::atomic<float>, ParameterIndex::count> values {};
+        std::array<juce::RangedAudioParameter*, ParameterIndex::count> parameters {};
+        std::vector<int> hostToRegistry;                    //The registry index of every parameter, by the host's parameter index
+
+        std::array<ListenerEntry, MAX_REGISTRY_LISTENERS> listeners;
+        std::atomic<int> numListeners { 0 };                //The entries before it are complete and never change again
+
+        /// @brief The index of every parameter, by id. Only used to build the host index lookup, so it's built on first use as well
+        static const std::unordered_map<juce::String, int>& getParameterIndexTable()
+        {
+            static const auto table = []
+            {
+                std::unordered_map<juce::String, int> indices;
+                const auto& ids = getParameterIDTable();
+                for(int i = 0; i < ParameterIndex::count; i++)
+                {
+                    indices.emplace(ids[(size_t)i], i);
+                }
+                return indices;
+            }();
+            return table;
+        }
+
+        static juce::String makeParameterID(int parameterIndex)
+        {
+            static constexpr const char* namedIDs[] =
+            {
+            #define VST_SYNTH_PARAMETER_ID(name) #name,
+                VST_SYNTH_NAMED_PARAMETERS(VST_SYNTH_PARAMETER_ID)
+            #undef VST_SYNTH_PARAMETER_ID
+            };
+
+            using namespace ParameterIndex;
+
+            if( parameterIndex < namedCount )
+                return namedIDs[parameterIndex];
+            if( parameterIndex < partialPhase )
+                return "partial" + juce::String(parameterIndex - partialGain) + "gain";
+            if( parameterIndex < eqBandGain )
+                return "partial" + juce::String(parameterIndex - partialPhase) + "phase";
+            if( parameterIndex < fxBypass )
+                return Effects::Equalizer::getBandGainParameterID(parameterIndex - eqBandGain);
+            if( parameterIndex < fxChoice )
+                return Effects::EffectsChain::getFXBypassParameterID(parameterIndex - fxBypass);
+
+            return Effects::EffectsChain::getFXChoiceParameterID(parameterIndex - fxChoice);
+        }
+
+        void parameterValueChanged(int hostIndex, float newValue) override
+        {
+            const int index = hostToRegistry[(size_t)hostIndex];
+            const float value = parameters[index]->convertFrom0to1(newValue);
+            values[index].store(value, std::memory_order_relaxed);
+
+            const int count = numListeners.load(std::memory_order_acquire);
+            for(int i = 0; i < count; i++)
+            {
+                const auto& listener = listeners[(size_t)i];
+                if( index >= listener.firstIndex && index < listener.endIndex && listener.active.load(std::memory_order_acquire) )
+                {
+                    listener.callback(index, value);
+                }
+            }
+        }
+
+        void parameterGestureChanged(int, bool) override {}
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ParameterRegistry)
+    };
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "ParameterRegistry.h"
+#include "Synthesizer/AdditiveSynthParameters.h"
+#include "Effects/Equalizer/EqualizerProcessor.h"
+#include "Effects/Filter/FilterProcessor.h"
+#include "Effects/Compressor/CompressorProcessor.h"
+#include "Effects/Delay/DelayProcessor.h"
+#include "Effects/Reverb/ReverbProcessor.h"
+#include "Effects/Chorus/ChorusProcessor.h"
+#include "Effects/Phaser/PhaserProcessor.h"
+#include "Effects/Tremolo/TremoloProcessor.h"
+
+namespace Processor
+{
+    /// @brief The values of every parameter the synth and the effects render with, read once at the start of a block.
+    /// Each group sits on its own cache lines, so a voice or an effect only touches the lines of its own group
+    struct ParameterSnapshot
+    {
+        Synthesizer::SynthParameterValues synth;
+
+        Effects::Equalizer::EqualizerParameterValues equalizer;
+        Effects::Filter::FilterParameterValues filter;
+        Effects::Compressor::CompressorParameterValues compressor;
+        Effects::Delay::DelayParameterValues delay;
+        Effects::Reverb::ReverbParameterValues reverb;
+        Effects::Chorus::ChorusParameterValues chorus;
+        Effects::Phaser::PhaserParameterValues phaser;
+        Effects::Tremolo::TremoloParameterValues tremolo;
+    };
+
+    /// @brief Fills a snapshot from the parameter registry. Each field is linked to its parameter's index once on construction, building the snapshot is a plain copy loop
+    class ParameterSnapshotBuilder
+    {
+    public:
+        ParameterSnapshotBuilder(const ParameterRegistry& registry, ParameterSnapshot& snapshot)
+        {
+            auto& synth = snapshot.synth;
+            link(registry, ParameterIndex::synthGain, synth.synthGain);
+            link(registry, ParameterIndex::oscillatorOctaves, synth.oscillatorOctaves);
+            link(registry, ParameterIndex::oscillatorSemitones, synth.oscillatorSemitones);
+            link(registry, ParameterIndex::oscillatorFine, synth.oscillatorFine);
+            link(registry, ParameterIndex::pitchWheelRange, synth.pitchWheelRange);
+            link(registry, ParameterIndex::globalPhase, synth.globalPhase);
+            link(registry, ParameterIndex::randomPhaseRange, synth.randomPhaseRange);
+            link(registry, ParameterIndex::unisonCount, synth.unisonCount);
+            link(registry, ParameterIndex::unisonDetune, synth.unisonDetune);
+            link(registry, ParameterIndex::unisonGain, synth.unisonGain);
+            link(registry, ParameterIndex::amplitudeADSRAttack, synth.amplitudeADSRAttack);
+            link(registry, ParameterIndex::amplitudeADSRDecay, synth.amplitudeADSRDecay);
+            link(registry, ParameterIndex::amplitudeADSRSustain, synth.amplitudeADSRSustain);
+            link(registry, ParameterIndex::amplitudeADSRRelease, synth.amplitudeADSRRelease);
+            link(registry, ParameterIndex::partialEngine, synth.partialEngine);
+            link(registry, ParameterIndex::partialDecay, synth.partialDecay);
+            link(registry, ParameterIndex::partialDecayTilt, synth.partialDecayTilt);
+            link(registry, ParameterIndex::partialSustain, synth.partialSustain);
+
+            for(int i = 0; i < Effects::Equalizer::NUM_BANDS; i++)
+            {
+                link(registry, ParameterIndex::eqBandGain + i, snapshot.equalizer.bandGains[i]);
+            }
+
+            link(registry, ParameterIndex::filterMix, snapshot.filter.mix);
+            link(registry, ParameterIndex::filterType, snapshot.filter.type);
+            link(registry, ParameterIndex::filterSlope, snapshot.filter.slope);
+            link(registry, ParameterIndex::filterCutoff, snapshot.filter.cutoff);
+
+            link(registry, ParameterIndex::compressorMix, snapshot.compressor.mix);
+            link(registry, ParameterIndex::compressorThreshold, snapshot.compressor.threshold);
+            link(registry, ParameterIndex::compressorRatio, snapshot.compressor.ratio);
+            link(registry, ParameterIndex::compressorAttack, snapshot.compressor.attack);
+            link(registry, ParameterIndex::compressorRelease, snapshot.compressor.release);
+
+            link(registry, ParameterIndex::delayMix, snapshot.delay.mix);
+            link(registry, ParameterIndex::delayFeedback, snapshot.delay.feedback);
+            link(registry, ParameterIndex::delayTime, snapshot.delay.time);
+            link(registry, ParameterIndex::delayFilterFrequency, snapshot.delay.filterFrequency);
+            link(registry, ParameterIndex::delayFilterQ, snapshot.delay.filterQ);
+
+            link(registry, ParameterIndex::reverbWet, snapshot.reverb.wet);
+            link(registry, ParameterIndex::reverbDry, snapshot.reverb.dry);
+            link(registry, ParameterIndex::reverbRoom, snapshot.reverb.room);
+            link(registry, ParameterIndex::reverbDamping, snapshot.reverb.damping);
+            link(registry, ParameterIndex::reverbWidth, snapshot.reverb.width);
+
+            link(registry, ParameterIndex::chorusMix, snapshot.chorus.mix);
+            link(registry, ParameterIndex::chorusRate, snapshot.chorus.rate);
+            link(registry, ParameterIndex::chorusDelay, snapshot.chorus.delay);
+            link(registry, ParameterIndex::chorusDepth, snapshot.chorus.depth);
+            link(registry, ParameterIndex::chorusFeedback, snapshot.chorus.feedback);
+
+            link(registry, ParameterIndex::phaserMix, snapshot.phaser.mix);
+            link(registry, ParameterIndex::phaserRate, snapshot.phaser.rate);
+            link(registry, ParameterIndex::phaserDepth, snapshot.phaser.depth);
+            link(registry, ParameterIndex::phaserFrequency, snapshot.phaser.frequency);
+            link(registry, ParameterIndex::phaserFeedback, snapshot.phaser.feedback);
+
+            link(registry, ParameterIndex::tremoloDepth, snapshot.tremolo.depth);
+            link(registry, ParameterIndex::tremoloRate, snapshot.tremolo.rate);
+            link(registry, ParameterIndex::tremoloAutoPan, snapshot.tremolo.autoPan);
+
+            build();
+        }
+
+        /// @brief Copies the current value of every parameter into the snapshot. Called once at the start of every block
+        void build() const
+        {
+            for(const auto& [source, destination] : links)
+            {
+                *destination = source->load(std::memory_order_relaxed);
+            }
+        }
+
+    private:
+        std::vector<std::pair<const std::atomic<float>*, float*>> links;
+
+        void link(const ParameterRegistry& registry, int parameterIndex, float& destination)
+        {
+            links.emplace_back(&registry[parameterIndex], &destination);
+        }
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ParameterSnapshotBuilder)
+    };
+}
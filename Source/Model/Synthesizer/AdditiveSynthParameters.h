@@ -11,47 +11,46 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "../ParameterRegistry.h"
 
 namespace Processor::Synthesizer
 {
     constexpr int SYNTH_MAX_VOICES = 32;                    //The number of voices the synth can handle simultaneously
 
-    struct AdditiveSynthParameters : public juce::AudioProcessorValueTreeState::Listener
+    /// @brief The values of the synthesizer's parameters for one block. Filled in by the parameter snapshot, read by the synth and its voices
+    struct alignas(64) SynthParameterValues
     {
-    public:
-        AdditiveSynthParameters(juce::AudioProcessorValueTreeState& apvts) : apvts(apvts)
-        {
-            linkParameters();
-            registerListener(this);
-        }
+        float synthGain = 0.f;
 
-        ~AdditiveSynthParameters() override
-        {
-            removeListener(this);
-        }
+        float oscillatorOctaves = 0.f;
+        float oscillatorSemitones = 0.f;
+        float oscillatorFine = 0.f;
+        float pitchWheelRange = 0.f;
 
-        void registerListener(juce::AudioProcessorValueTreeState::Listener* listener) const
-        {
-            auto paramLayoutSchema = createParameterLayout();
-            auto params = paramLayoutSchema->getParameters(false);
-
-            for(auto param : params)
-            {
-                auto id = dynamic_cast<juce::RangedAudioParameter*>(param)->getParameterID();
-                apvts.addParameterListener(id, listener);
-            }
-        }
+        float globalPhase = 0.f;
+        float randomPhaseRange = 0.f;
 
-        void removeListener(juce::AudioProcessorValueTreeState::Listener* listener) const
+        float unisonCount = 0.f;
+        float unisonDetune = 0.f;
+        float unisonGain = 0.f;
+
+        float amplitudeADSRAttack = 0.f;
+        float amplitudeADSRDecay = 0.f;
+        float amplitudeADSRSustain = 0.f;
+        float amplitudeADSRRelease = 0.f;
+
+        float partialEngine = 0.f;
+        float partialDecay = 0.f;
+        float partialDecayTilt = 0.f;
+        float partialSustain = 0.f;
+    };
+
+    struct AdditiveSynthParameters
+    {
+    public:
+        AdditiveSynthParameters(const ParameterRegistry& registry)
         {
-            auto paramLayoutSchema = createParameterLayout();
-            auto params = paramLayoutSchema->getParameters(false);
-
-            for(auto param : params)
-            {
-                auto id = dynamic_cast<juce::RangedAudioParameter*>(param)->getParameterID();
-                apvts.removeParameterListener(id, listener);
-            }
+            linkParameters(registry);
         }
 
         /// @brief Creates and adds the synthesizer's parameters into a parameter group
@@ -183,6 +182,37 @@ namespace Processor::Synthesizer
                 50.f);
             synthGroup.get()->addChild(std::move(release));
 
+            //Renders every partial with its own sine oscillator instead of the wavetable, so the partials can have envelopes
+            auto partialEngine = std::make_unique<juce::AudioParameterBool>(
+                "partialEngine",
+                "Partial Envelopes",
+                false);
+            synthGroup.get()->addChild(std::move(partialEngine));
+
+            //Decay time of the lowest octave of partials in ms. The partials decay from full level to the partial sustain level
+            auto partialDecay = std::make_unique<juce::AudioParameterFloat>(
+                "partialDecay",
+                "Partial Decay",
+                juce::NormalisableRange<float>(1.f, 10000.f, 0.1, 0.45), 
+                1000.f);
+            synthGroup.get()->addChild(std::move(partialDecay));
+
+            //How much faster each octave of partials decays than the one below it, in percent
+            auto partialDecayTilt = std::make_unique<juce::AudioParameterFloat>(
+                "partialDecayTilt",
+                "Partial Decay Tilt",
+                juce::NormalisableRange<float>(0.f, 100.f, 0.1), 
+                0.f);
+            synthGroup.get()->addChild(std::move(partialDecayTilt));
+
+            //The level the partials decay to in linear amplitude
+            auto partialSustain = std::make_unique<juce::AudioParameterFloat>(
+                "partialSustain",
+                "Partial Sustain",
+                juce::NormalisableRange<float>(0.f, 100.f, 0.1), 
+                100.f);
+            synthGroup.get()->addChild(std::move(partialSustain));
+
             return synthGroup;
         }
 
@@ -204,41 +234,32 @@ namespace Processor::Synthesizer
         const std::atomic<float>* amplitudeADSRDecay;
         const std::atomic<float>* amplitudeADSRSustain;
         const std::atomic<float>* amplitudeADSRRelease;
-    private:
-        juce::AudioProcessorValueTreeState& apvts;
-        std::unordered_map<juce::String, std::atomic<float>> paramMap;
-
-        void parameterChanged(const juce::String &parameterID, float newValue) override
-        {
-            paramMap[parameterID] = newValue;
-        }
 
-        void linkParameters()
+        const std::atomic<float>* partialEngine;
+        const std::atomic<float>* partialDecay;
+        const std::atomic<float>* partialDecayTilt;
+        const std::atomic<float>* partialSustain;
+    private:
+        void linkParameters(const ParameterRegistry& registry)
         {
-            auto paramLayoutSchema = createParameterLayout();
-
-            auto params = paramLayoutSchema->getParameters(false);
-            for ( auto param : params )
-            {
-                auto id = dynamic_cast<juce::RangedAudioParameter*>(param)->getParameterID();
-                auto value = dynamic_cast<juce::RangedAudioParameter*>(param)->getNormalisableRange().convertFrom0to1(param->getDefaultValue());
-                paramMap.emplace(id, value);
-            }
-
-            synthGain = &paramMap["synthGain"];
-            oscillatorOctaves = &paramMap["oscillatorOctaves"];
-            oscillatorSemitones = &paramMap["oscillatorSemitones"];
-            oscillatorFine = &paramMap["oscillatorFine"];
-            pitchWheelRange = &paramMap["pitchWheelRange"];
-            globalPhase = &paramMap["globalPhase"];
-            randomPhaseRange = &paramMap["randomPhaseRange"];
-            unisonCount = &paramMap["unisonCount"];
-            unisonDetune = &paramMap["unisonDetune"];
-            unisonGain = &paramMap["unisonGain"];
-            amplitudeADSRAttack = &paramMap["amplitudeADSRAttack"];
-            amplitudeADSRDecay = &paramMap["amplitudeADSRDecay"];
-            amplitudeADSRSustain = &paramMap["amplitudeADSRSustain"];
-            amplitudeADSRRelease = &paramMap["amplitudeADSRRelease"];
+            synthGain = &registry[ParameterIndex::synthGain];
+            oscillatorOctaves = &registry[ParameterIndex::oscillatorOctaves];
+            oscillatorSemitones = &registry[ParameterIndex::oscillatorSemitones];
+            oscillatorFine = &registry[ParameterIndex::oscillatorFine];
+            pitchWheelRange = &registry[ParameterIndex::pitchWheelRange];
+            globalPhase = &registry[ParameterIndex::globalPhase];
+            randomPhaseRange = &registry[ParameterIndex::randomPhaseRange];
+            unisonCount = &registry[ParameterIndex::unisonCount];
+            unisonDetune = &registry[ParameterIndex::unisonDetune];
+            unisonGain = &registry[ParameterIndex::unisonGain];
+            amplitudeADSRAttack = &registry[ParameterIndex::amplitudeADSRAttack];
+            amplitudeADSRDecay = &registry[ParameterIndex::amplitudeADSRDecay];
+            amplitudeADSRSustain = &registry[ParameterIndex::amplitudeADSRSustain];
+            amplitudeADSRRelease = &registry[ParameterIndex::amplitudeADSRRelease];
+            partialEngine = &registry[ParameterIndex::partialEngine];
+            partialDecay = &registry[ParameterIndex::partialDecay];
+            partialDecayTilt = &registry[ParameterIndex::partialDecayTilt];
+            partialSustain = &registry[ParameterIndex::partialSustain];
         }
 
         JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AdditiveSynthParameters)
@@ -12,16 +12,17 @@
 
 namespace Processor::Synthesizer
 {
-    AdditiveSynthesizer::AdditiveSynthesizer(juce::AudioProcessorValueTreeState& apvts) :
+    AdditiveSynthesizer::AdditiveSynthesizer(juce::AudioProcessorValueTreeState& apvts, ParameterRegistry& registry, const SynthParameterValues& blockParameters) :
                             AudioProcessor(BusesProperties().withOutput("Output", juce::AudioChannelSet::stereo())),
-                            oscParameters(apvts),
-                            synthParameters(apvts)
+                            synthParameters(registry),
+                            blockParameters(blockParameters),
+                            oscParameters(apvts, registry)
     {
         synth.addSound(new AdditiveSound());
 
         for(int i = 0; i < SYNTH_MAX_VOICES; i++)
         {
-            synth.addVoice(new AdditiveVoice(synthParameters, oscParameters.getLookupTable()));
+            synth.addAdditiveVoice(blockParameters);
         }
         synth.setNoteStealingEnabled(true);
     }
@@ -35,6 +36,7 @@ namespace Processor::Synthesizer
     void AdditiveSynthesizer::prepareToPlay(double sampleRate, int maximumExpectedSamplesPerBlock)
     {
         synth.setCurrentPlaybackSampleRate(sampleRate);
+        synth.prepareVoiceBank(maximumExpectedSamplesPerBlock);
         for(int i = 0; i < synth.getNumVoices(); i++)
         {
             if (auto voice = dynamic_cast<AdditiveVoice*>(synth.getVoice(i)))
@@ -52,12 +54,38 @@ namespace Processor::Synthesizer
 
     void AdditiveSynthesizer::processBlock(juce::AudioBuffer<float> &buffer, juce::MidiBuffer &midiMessages)
     {
-        synth.renderNextBlock(buffer, midiMessages, 0, buffer.getNumSamples());
+        idle = midiMessages.isEmpty() && !synth.hasActiveVoices();
+        if( idle )
+        {   //Nothing could start or sound in this block, so there is nothing to add to the buffer
+            return;
+        }
+
+        {   //Every voice renders the whole block from the set that was current when it started, which stays alive until the scope ends
+            auto wavetables = oscParameters.getWavetables().read();
+            synth.setBlockWavetables(wavetables.get());
+            synth.renderNextBlock(buffer, midiMessages, 0, buffer.getNumSamples());
+            synth.setBlockWavetables(nullptr);
+
+            oscParameters.requestMissingLevels(*wavetables);
+        }
 
         juce::dsp::AudioBlock<float> audioBlock { buffer };
 
-        synthGain.setGainLinear(synthParameters.synthGain->load() / 100);
+        synthGain.setGainLinear(blockParameters.synthGain / 100);
+
+        if( synth.isMonoOutputEnabled() && buffer.getNumChannels() > 1 )
+        {   //Everything up to here is identical on both channels, the first stage that needs stereo is the effect chain
+            auto monoBlock = audioBlock.getSingleChannelBlock(0);
+            synthGain.process(juce::dsp::ProcessContextReplacing<float>(monoBlock));
 
-        synthGain.process(juce::dsp::ProcessContextReplacing<float>(audioBlock));
+            for(int channel = 1; channel < buffer.getNumChannels(); channel++)
+            {
+                buffer.copyFrom(channel, 0, buffer, 0, 0, buffer.getNumSamples());
+            }
+        }
+        else
+        {
+            synthGain.process(juce::dsp::ProcessContextReplacing<float>(audioBlock));
+        }
     }
 }
@@ -16,13 +16,16 @@
 #include "AdditiveSynthParameters.h"
 #include "AdditiveSound.h"
 #include "AdditiveVoice.h"
+#include "VoiceBankSynthesiser.h"
+#include "../../Utils/RealtimeSanitizer.h"
 
 namespace Processor::Synthesizer
 {
     class AdditiveSynthesizer : public juce::AudioProcessor
     {
     public:
-        AdditiveSynthesizer(juce::AudioProcessorValueTreeState&);
+        /// @param blockParameters The parameter values the synth and its voices render with. The owner updates them at the start of every block
+        AdditiveSynthesizer(juce::AudioProcessorValueTreeState&, ParameterRegistry& registry, const SynthParameterValues& blockParameters);
         ~AdditiveSynthesizer() override;
 
         const juce::String getName() const override { return "Additive Synthesizer"; }
@@ -51,17 +54,53 @@ namespace Processor::Synthesizer
             return oscParameters;
         }
 
+        OscillatorParameters& getOscParameters()
+        {
+            return oscParameters;
+        }
+
         const AdditiveSynthParameters& getSynthParameters() const
         {
             return synthParameters;
         }
 
+        /// @brief Switches between rendering all voices with the batched voice bank engine, or each voice on its own
+        void setVoiceBankEnabled(bool shouldBeEnabled)
+        {
+            synth.setBatchRenderingEnabled(shouldBeEnabled);
+        }
+
+        /// @brief Switches rendering the whole synth in mono. The voices only render the first channel, which is copied to the second one at the end of processBlock, right before the effects
+        void setMonoOutputEnabled(bool shouldBeEnabled)
+        {
+            synth.setMonoOutputEnabled(shouldBeEnabled);
+        }
+
+        /// @brief Switches rendering the active voices on a pool of real-time worker threads. Only used with the voice bank engine, the workers are started in prepareToPlay
+        void setParallelRenderingEnabled(bool shouldBeEnabled)
+        {
+            synth.setParallelRenderingEnabled(shouldBeEnabled);
+        }
+
+        /// @brief Sets the level below which decaying voices are faded out and freed early, VOICE_CULL_THRESHOLD_DB by default
+        /// @param decibels The threshold relative to a voice at full velocity, or minus infinity to render every release to the end
+        void setVoiceCullThreshold(float decibels)
+        {
+            synth.setVoiceCullThreshold(decibels);
+        }
+
+        /// @return True if the last block had no voice to render and no MIDI to handle. Nothing was added to the buffer then, not even the gain was applied
+        bool isIdle() const { return idle; }
+
     private:
         AdditiveSynthParameters synthParameters;
+        const SynthParameterValues& blockParameters;
         OscillatorParameters oscParameters;
 
         juce::dsp::Gain<float> synthGain;
-        juce::Synthesiser synth;
+        VoiceBankSynthesiser synth;
+        Utils::RealtimeLockAllowance synthLockAllowance { synth.getLock(), "juce::Synthesiser takes it in renderNextBlock, the voices and sounds are only changed while audio is stopped" };
+        bool idle = true;
         
         //==============================================================================
         JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AdditiveSynthesizer)
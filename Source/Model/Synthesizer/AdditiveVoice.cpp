@@ -13,15 +13,19 @@
 namespace Processor::Synthesizer
 {
     AdditiveVoice::AdditiveVoice(
-        AdditiveSynthParameters& synthParams,
-        const juce::OwnedArray<Utils::TripleBuffer<juce::dsp::LookupTableTransform<float>>>& mipMap) :
+        const SynthParameterValues& synthParams,
+        VoiceAngleData& angleData,
+        VoiceEnvelope& envelope,
+        const std::atomic<float>& cullThreshold) :
             synthParameters(synthParams),
-            mipMap(mipMap)
+            voiceData(angleData),
+            amplitudeEnvelope(envelope),
+            cullThresholdGain(cullThreshold)
     {}
 
     bool AdditiveVoice::isVoiceActive() const
     {
-        return ( getCurrentlyPlayingNote() >= 0 || amplitudeADSR.isActive() );
+        return ( getCurrentlyPlayingNote() >= 0 || amplitudeEnvelope.isActive() );
     }
 
     void AdditiveVoice::pitchWheelMoved(int newPitchWheelValue)
@@ -37,22 +41,23 @@ namespace Processor::Synthesizer
         currentNote = midiNoteNumber;
         velocityGain = velocity;
         pitchWheelOffset = ((float)currentPitchWheelPosition-8192)/8192;
+        voiceData.elapsedSamples = 0;
 
         updatePhases();
         updateFrequencies();
         updateAngles();
 
         updateADSRParams();
-        if(amplitudeADSR.isActive())
-            amplitudeADSR.reset();
-        amplitudeADSR.noteOn();
+        if(amplitudeEnvelope.isActive())
+            amplitudeEnvelope.reset();
+        amplitudeEnvelope.noteOn();
     }
 
     void AdditiveVoice::stopNote(float velocity, bool allowTailOff)
     {
-        amplitudeADSR.noteOff();
+        amplitudeEnvelope.noteOff();
         
-        if( !allowTailOff || !amplitudeADSR.isActive() )
+        if( !allowTailOff || !amplitudeEnvelope.isActive() )
         {
             clearCurrentNote();
             resetProperties();
@@ -60,117 +65,92 @@ namespace Processor::Synthesizer
     }
 
     void AdditiveVoice::renderNextBlock(juce::AudioBuffer<float>& outputBuffer, int startSample, int numSamples)
-    {   //No point in updating variables and calculating samples if velocity is 0 or if the voice is not in use
-        if( isVoiceActive() && velocityGain > 0.f )
+    {
+        if( auto* localMipMap = prepareBlock() )
         {
-            if( !bypassPlaying )
+            generatedBuffer.setSize(2, numSamples, false, false, true);
+            generatedBuffer.clear();
+
+            /*render buffer*/
+            const int renderChannels = getRenderChannels();
+            renderOscillators(voiceData, *localMipMap, generatedBuffer.getArrayOfWritePointers(), numSamples, renderChannels);
+
+            //Applying the envelope to the buffer
+            amplitudeEnvelope.applyToBuffer(generatedBuffer, 0, numSamples);
+
+            for (int channel = 0; channel < 2; channel++)
             {
-                generatedBuffer.clear();
-                generatedBuffer.setSize(2, numSamples, false, false, true);
-
-                unisonPairCount = (int)synthParameters.unisonCount->load();
-                unisonGain = synthParameters.unisonGain->load() / 100.f;
-
-                mipMap[mipMapIndex]->acquire();
-                auto& localMipMap = mipMap[mipMapIndex]->read();
-
-                /*render buffer*/
-                for (int channel = 0; channel < 2; channel++)
-                {
-                    auto* bufferPointer = generatedBuffer.getWritePointer(channel, 0);
-
-                    for (int sample = 0; sample < numSamples; sample++)
-                    {
-                        //Generating the fundamental data for the sample
-                        bufferPointer[sample] += getFundamentalSample(channel, localMipMap);
-
-                        //Generating unison data for the sample
-                        if( unisonGain > 0.f )
-                        {
-                            float unisonSample = 0.f;
-                            for (int unison = 0; unison < unisonPairCount; unison++)
-                            {
-                                unisonSample += getUnisonSample(channel, unison, localMipMap);
-                            }
-                            unisonSample *= unisonGain;
-
-                            bufferPointer[sample] += unisonSample;
-                        }
-
-                        bufferPointer[sample] *= velocityGain;
-                    }
-                }
-
-                //Applying the envelope to the buffer
-                amplitudeADSR.applyEnvelopeToBuffer(generatedBuffer, 0, numSamples);
-                
-                for (int channel = 0; channel < 2; channel++)
-                {
-                    outputBuffer.addFrom(channel, startSample, generatedBuffer, channel, 0, numSamples);
-
-                    if (!amplitudeADSR.isActive())
-                    {
-                        clearCurrentNote();
-                    }
-                }
+                outputBuffer.addFrom(channel, startSample, generatedBuffer, channel % renderChannels, 0, numSamples);
             }
-            updateFrequencies();
-            updateAngles();
         }
+        finishBlock();
     }
 
-    const float AdditiveVoice::getFundamentalSample(const int channel, const juce::dsp::LookupTableTransform<float>& localMipMap)
-    {
-        if (voiceData.currentAngle[channel] > juce::MathConstants<float>::twoPi)
+    const Wavetable* AdditiveVoice::prepareBlock()
+    {   //No point in updating variables and calculating samples if velocity is 0 or if the voice is not in use
+        renderingBlock = isVoiceActive() && velocityGain > 0.f;
+
+        if( !renderingBlock || bypassPlaying || blockWavetables == nullptr )
         {
-            voiceData.currentAngle[channel] -= juce::MathConstants<float>::twoPi;
+            return nullptr;
         }
 
-        //Generating the fundamental data for the sample
-        float sample = localMipMap[voiceData.currentAngle[channel]];
+        updateLaneGains();
 
-        voiceData.currentAngle[channel] += voiceData.angleDelta;
-
-        return sample;
+        return &blockWavetables->findLevel(mipMapIndex);
     }
 
-    const float AdditiveVoice::getUnisonSample(const int channel, const int unisonNumber, const juce::dsp::LookupTableTransform<float>& localMipMap)
+    void AdditiveVoice::finishBlock()
     {
-        if (voiceData.unisonData[unisonNumber].upperCurrentAngle[channel] > juce::MathConstants<float>::twoPi)
+        if( renderingBlock )
         {
-            voiceData.unisonData[unisonNumber].upperCurrentAngle[channel] -= juce::MathConstants<float>::twoPi;
-        }
-        if (voiceData.unisonData[unisonNumber].lowerCurrentAngle[channel] > juce::MathConstants<float>::twoPi)
-        {
-            voiceData.unisonData[unisonNumber].lowerCurrentAngle[channel] -= juce::MathConstants<float>::twoPi;
+            if( !bypassPlaying && !amplitudeEnvelope.isActive() )
+            {
+                clearCurrentNote();
+            }
+            else
+            {   //Keeps long releases from being rendered at full cost long after they can be heard
+                const float threshold = cullThresholdGain.load(std::memory_order_relaxed) / velocityGain;
+                amplitudeEnvelope.cullBelow(threshold, (int)std::ceil(VOICE_CULL_FADE_SECONDS * getSampleRate()));
+            }
+
+            updateFrequencies();
+            updateAngles();
         }
+        renderingBlock = false;
+    }
 
-        float sample = localMipMap[voiceData.unisonData[unisonNumber].upperCurrentAngle[channel]];
-        sample += localMipMap[voiceData.unisonData[unisonNumber].lowerCurrentAngle[channel]];
+    void AdditiveVoice::updateLaneGains()
+    {
+        unisonPairCount = (int)synthParameters.unisonCount;
+        unisonGain = synthParameters.unisonGain / 100.f;
 
-        voiceData.unisonData[unisonNumber].upperCurrentAngle[channel] += voiceData.unisonData[unisonNumber].upperAngleDelta;
-        voiceData.unisonData[unisonNumber].lowerCurrentAngle[channel] += voiceData.unisonData[unisonNumber].lowerAngleDelta;
+        voiceData.activeLanes = unisonGain > 0.f ? 1 + 2 * unisonPairCount : 1;
 
-        return sample;
+        voiceData.gain[0] = velocityGain;
+        for (int lane = 1; lane < OSCILLATOR_LANES; lane++)
+        {
+            voiceData.gain[lane] = lane < voiceData.activeLanes ? unisonGain * velocityGain : 0.f;
+        }
     }
 
     void AdditiveVoice::updatePhases()
     {
-        unisonPairCount = synthParameters.unisonCount->load();
+        unisonPairCount = synthParameters.unisonCount;
         for (int channel = 0; channel < 2; channel++)
         {
-            voiceData.currentAngle[channel] = getRandomPhase() + ( ( synthParameters.globalPhase->load() / 100 ) * juce::MathConstants<float>::twoPi );
-            for (int unison = 0; unison < unisonPairCount; unison++)
+            for (int lane = 0; lane < 1 + 2 * unisonPairCount; lane++)
             {
-                voiceData.unisonData[unison].upperCurrentAngle[channel] = getRandomPhase() + ( ( synthParameters.globalPhase->load() / 100 ) * juce::MathConstants<float>::twoPi );
-                voiceData.unisonData[unison].lowerCurrentAngle[channel] = getRandomPhase() + ( ( synthParameters.globalPhase->load() / 100 ) * juce::MathConstants<float>::twoPi );
+                voiceData.phase[channel][lane] = VoiceAngleData::cyclesToPhase( ( getRandomPhase() / juce::MathConstants<float>::twoPi ) + ( synthParameters.globalPhase / 100 ) );
             }
-        }       
+        }
+
+        identicalChannels = std::equal(std::begin(voiceData.phase[0]), std::end(voiceData.phase[0]), std::begin(voiceData.phase[1]));
     }
 
     const float AdditiveVoice::getRandomPhase()
     {
-        float randomPhaseRange = synthParameters.randomPhaseRange->load();
+        float randomPhaseRange = synthParameters.randomPhaseRange;
         float randomPhase = 0.f;
 
         if(randomPhaseRange > 0.f)
@@ -187,18 +167,19 @@ namespace Processor::Synthesizer
         voiceData.frequency = 440.f * pow(2, ((float)currentNote - 69.f) / 12);
 
         //Applying octave, semitone and fine tuning and pitchwheel offsets
-        float unifiedGlobalTuningOffset = pow(2, synthParameters.oscillatorOctaves->load() + (synthParameters.oscillatorSemitones->load() / 12) + (synthParameters.oscillatorFine->load() / 1200) + (synthParameters.pitchWheelRange->load() * pitchWheelOffset / 12));
+        float unifiedGlobalTuningOffset = pow(2, synthParameters.oscillatorOctaves + (synthParameters.oscillatorSemitones / 12) + (synthParameters.oscillatorFine / 1200) + (synthParameters.pitchWheelRange * pitchWheelOffset / 12));
         voiceData.frequency *= unifiedGlobalTuningOffset;
 
         /*Calculating evenly spaced unison frequency offsets and applying the global tuning offset*/
-        unisonPairCount = synthParameters.unisonCount->load();
-        float unisonTuningRange = pow(2, synthParameters.unisonDetune->load() / 1200);
+        unisonPairCount = synthParameters.unisonCount;
+        float unisonTuningRange = pow(2, synthParameters.unisonDetune / 1200);
         float unisonTuningStep = (unisonTuningRange - 1) / unisonPairCount;
 
+        voiceData.frequencyOffset[0] = 1.f;
         for (int unison = 0; unison < unisonPairCount; unison++)
         {
-            voiceData.unisonData[unison].upperFrequencyOffset = 1.f + (unisonTuningStep * (unison + 1));
-            voiceData.unisonData[unison].lowerFrequencyOffset = 1.f / ( 1.f + (unisonTuningStep * (unison + 1)));
+            voiceData.frequencyOffset[VoiceAngleData::getUpperLane(unison)] = 1.f + (unisonTuningStep * (unison + 1));
+            voiceData.frequencyOffset[VoiceAngleData::getLowerLane(unison)] = 1.f / ( 1.f + (unisonTuningStep * (unison + 1)));
         }
 
         if (unisonPairCount > 0)
@@ -216,29 +197,18 @@ namespace Processor::Synthesizer
     void AdditiveVoice::updateAngles()
     {
         auto sampleRate = getSampleRate();
-        float cyclesPerSample = voiceData.frequency / sampleRate;
-        voiceData.angleDelta = cyclesPerSample * juce::MathConstants<float>::twoPi;
 
-        unisonPairCount = synthParameters.unisonCount->load();
-        for (int unison = 0; unison < unisonPairCount; unison++)
+        unisonPairCount = synthParameters.unisonCount;
+        for (int lane = 0; lane < 1 + 2 * unisonPairCount; lane++)
         {
-            cyclesPerSample = (voiceData.frequency * voiceData.unisonData[unison].upperFrequencyOffset) / sampleRate;
-            voiceData.unisonData[unison].upperAngleDelta = cyclesPerSample * juce::MathConstants<float>::twoPi;
-
-            cyclesPerSample = (voiceData.frequency * voiceData.unisonData[unison].lowerFrequencyOffset) / sampleRate;
-            voiceData.unisonData[unison].lowerAngleDelta = cyclesPerSample * juce::MathConstants<float>::twoPi;
+            double cyclesPerSample = (voiceData.frequency * voiceData.frequencyOffset[lane]) / sampleRate;
+            voiceData.phaseIncrement[lane] = VoiceAngleData::cyclesToPhase(cyclesPerSample);
         }
     }
 
     void AdditiveVoice::findMipMapToUse()
     {
-        float highestGeneratedOvertone = getSampleRate();
-        mipMapIndex = -1;
-        while (highestGeneratedOvertone >= (getSampleRate() / 2) && mipMapIndex < LOOKUP_SIZE)
-        {
-            mipMapIndex++;
-            highestGeneratedOvertone = highestCurrentFrequency * std::ceilf((HARMONIC_N / pow(2.f, (float)mipMapIndex)));
-        }
+        mipMapIndex = findMipMapLevel(highestCurrentFrequency, getSampleRate() / 2);
 
         if(mipMapIndex >= LOOKUP_SIZE)
         {   //The lowest usable frequency exceeds or equals the Nyquist frequency. None of the generated signal would be valid data at this point
@@ -272,13 +242,13 @@ namespace Processor::Synthesizer
     {
         juce::ADSR::Parameters params;
 
-        amplitudeADSR.setSampleRate(getSampleRate());
+        amplitudeEnvelope.setSampleRate(getSampleRate());
 
-        params.attack = synthParameters.amplitudeADSRAttack->load() / 1000;
-        params.decay = synthParameters.amplitudeADSRDecay->load() / 1000;
-        params.sustain = synthParameters.amplitudeADSRSustain->load() / 100;
-        params.release = synthParameters.amplitudeADSRRelease->load() / 1000;
+        params.attack = synthParameters.amplitudeADSRAttack / 1000;
+        params.decay = synthParameters.amplitudeADSRDecay / 1000;
+        params.sustain = synthParameters.amplitudeADSRSustain / 100;
+        params.release = synthParameters.amplitudeADSRRelease / 1000;
 
-        amplitudeADSR.setParameters(params);
+        amplitudeEnvelope.setParameters(params);
     }
 }
\ No newline at end of file
@@ -13,57 +13,16 @@
 #include <JuceHeader.h>
 #include "OscillatorParameters.h"
 #include "AdditiveSynthParameters.h"
+#include "OscillatorKernel.h"
+#include "VoiceEnvelope.h"
 
 namespace Processor::Synthesizer
 {
-    struct UnisonPairAngleData
-    {
-        float upperCurrentAngle[2] = {0.f , 0.f};
-        float lowerCurrentAngle[2] = {0.f , 0.f};
-        float upperAngleDelta = 0.f;
-        float lowerAngleDelta = 0.f;
-        float upperFrequencyOffset = 0.f;
-        float lowerFrequencyOffset = 0.f;
-
-        void reset()
-        {
-            upperCurrentAngle[0] = 0.f;
-            upperCurrentAngle[1] = 0.f;
-            lowerCurrentAngle[0] = 0.f;
-            lowerCurrentAngle[1] = 0.f;
-            upperAngleDelta = 0.f;
-            lowerAngleDelta = 0.f;
-            upperFrequencyOffset = 0.f;
-            lowerFrequencyOffset = 0.f;
-        }
-    };
-
-    struct VoiceAngleData
-    {
-        float currentAngle[2] = {0.f , 0.f};
-        float angleDelta = 0.f;
-        float frequency = 0.f;
-
-        UnisonPairAngleData unisonData[5];
-
-        void reset()
-        {
-            currentAngle[0] = 0.f;
-            currentAngle[1] = 0.f;
-            angleDelta = 0.f;
-            frequency = 0.f;
-
-            for (int i = 0; i < 5; i++)
-            {
-                unisonData[i].reset();
-            }
-        }
-    };
-
     class AdditiveVoice : public juce::SynthesiserVoice
     {
     public:
-        AdditiveVoice(AdditiveSynthParameters& synthParams, const juce::OwnedArray<Utils::TripleBuffer<juce::dsp::LookupTableTransform<float>>>& mipMap);
+        /// @param cullThreshold The envelope gain below which a decaying voice is faded out, shared by every voice of the synth
+        AdditiveVoice(const SynthParameterValues& synthParams, VoiceAngleData& angleData, VoiceEnvelope& envelope, const std::atomic<float>& cullThreshold);
 
         bool canPlaySound(juce::SynthesiserSound* sound) override { return sound != nullptr; }
         void controllerMoved(int controllerNumber, int newControllerValue) override {}
@@ -74,19 +33,40 @@ namespace Processor::Synthesizer
         void stopNote(float velocity, bool allowTailOff) override;
 
         void renderNextBlock(juce::AudioBuffer<float>& outputBuffer, int startSample, int numSamples) override;
+
+        /// @brief Allocates the render buffer for the largest block the voice will be asked to render, so renderNextBlock never has to
+        void prepare(int maximumBlockSize) { generatedBuffer.setSize(2, maximumBlockSize); }
+
+        /// @brief Sets the wavetables the voice renders the next block with. The owner keeps them alive until the block is rendered
+        void setBlockWavetables(const WavetableSet* wavetables) { blockWavetables = wavetables; }
+
+        /// @brief Updates the per-block state of the voice before its oscillators are rendered
+        /// @return The mipmap level to render with, or nullptr if the voice has nothing to render in this block
+        const Wavetable* prepareBlock();
+
+        /// @brief Finishes the block started with prepareBlock. Frees the voice if its envelope has ended, starts fading it out once it has decayed below the cull threshold and follows parameter changes
+        void finishBlock();
+
+        /// @brief Tells how many channels the voice has to render. Notes that start with the same phases on both channels stay identical, so one channel is enough for them
+        int getRenderChannels() const { return identicalChannels ? 1 : 2; }
+
+        VoiceAngleData& getAngleData() { return voiceData; }
+        VoiceEnvelope& getEnvelope() { return amplitudeEnvelope; }
     private:
         juce::AudioBuffer<float> generatedBuffer;
-        AdditiveSynthParameters& synthParameters;
+        const SynthParameterValues& synthParameters;   //The values of the current block
         
         juce::Random rng;
 
-        const juce::OwnedArray<Utils::TripleBuffer<juce::dsp::LookupTableTransform<float>>>& mipMap;
+        const WavetableSet* blockWavetables = nullptr;
 
-        VoiceAngleData voiceData;
+        VoiceAngleData& voiceData;
 
         float velocityGain = 0;
         int currentNote = 0;
         bool bypassPlaying = false;
+        bool renderingBlock = false;
+        bool identicalChannels = false;
 
         int unisonPairCount = 0;
         float unisonGain = 0.f;
@@ -96,18 +76,11 @@ namespace Processor::Synthesizer
         float highestCurrentFrequency = 0.f;
         int mipMapIndex = 0;
 
-        juce::ADSR amplitudeADSR;
-
-        /// @brief Generates a sample for the fundamental of the voice
-        /// @param channel The channel where the sample is needed (for random phase per channel)
-        /// @return The generated sample
-        const float getFundamentalSample(const int channel, const juce::dsp::LookupTableTransform<float>& localMipMap);
+        VoiceEnvelope& amplitudeEnvelope;
+        const std::atomic<float>& cullThresholdGain;
 
-        /// @brief Generates a sample for the unison of the voice
-        /// @param channel The channel where the sample is needed (for random phase per channel)
-        /// @param unisonNumber The unison pair to generate with
-        /// @return The generated sample
-        const float getUnisonSample(const int channel, const int unisonNumber, const juce::dsp::LookupTableTransform<float>& localMipMap);
+        /// @brief Sets the gains of the oscillator lanes from the velocity and the current unison settings
+        void updateLaneGains();
 
         /// @brief Used to randomise the starting phases of all generated waveforms
         void updatePhases();
@@ -119,7 +92,7 @@ namespace Processor::Synthesizer
         /// @brief Called to update frequencies with current parameters
         void updateFrequencies();
 
-        /// @brief Used to generate new angle deltas for the given frequencies the voice is expected to generate
+        /// @brief Used to generate new phase increments for the given frequencies the voice is expected to generate
         void updateAngles();
 
         /// @brief Checks the highest possible overtone the current highest generated frequency (including the up-tuned unison voices) that can safely be generated without aliasing at the current sample-rate and selects the right lookup table with the correct number of overtones. Playback is skipped entirely if such a look-up table doesn't exist
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "Wavetable.h"
+
+namespace Processor::Synthesizer
+{
+    using SIMDFloat = juce::dsp::SIMDRegister<float>;
+    using SIMDPhase = juce::dsp::SIMDRegister<uint32_t>;
+
+    constexpr int UNISON_MAX_PAIRS = 5;                     //The number of unison pairs a voice can play
+    constexpr int SIMD_WIDTH = (int)SIMDFloat::SIMDNumElements;
+    constexpr int OSCILLATOR_LANES = ( ( 1 + 2 * UNISON_MAX_PAIRS + SIMD_WIDTH - 1 ) / SIMD_WIDTH ) * SIMD_WIDTH; //The fundamental and every up/down tuned unison oscillator, padded to a whole number of SIMD registers
+
+    static_assert((int)SIMDPhase::SIMDNumElements == SIMD_WIDTH, "Phases and samples need the same number of lanes per register");
+
+    /// @brief The oscillator state of a voice, stored as structure of arrays. Lane 0 is the fundamental, lanes 2n+1 and 2n+2 are the upper and lower oscillator of unison pair n.
+    /// Phases are unsigned 32 bit accumulators where the full range is one cycle, so they wrap around on their own and keep the same precision however long a note is held
+    struct VoiceAngleData
+    {
+        alignas(32) uint32_t phase[2][OSCILLATOR_LANES] {};
+        alignas(32) uint32_t phaseIncrement[OSCILLATOR_LANES] {};
+        alignas(32) float gain[OSCILLATOR_LANES] {};
+        float frequencyOffset[OSCILLATOR_LANES] {};         //The frequency of each oscillator relative to the fundamental
+        float frequency = 0.f;
+        int64_t elapsedSamples = 0;                         //The number of samples rendered since the note started
+
+        int activeLanes = 1;
+
+        void reset()
+        {
+            for (int channel = 0; channel < 2; channel++)
+            {
+                std::fill(std::begin(phase[channel]), std::end(phase[channel]), 0u);
+            }
+            std::fill(std::begin(phaseIncrement), std::end(phaseIncrement), 0u);
+            std::fill(std::begin(gain), std::end(gain), 0.f);
+            std::fill(std::begin(frequencyOffset), std::end(frequencyOffset), 0.f);
+            frequency = 0.f;
+            elapsedSamples = 0;
+            activeLanes = 1;
+        }
+
+        static int getUpperLane(int unison) { return 2 * unison + 1; }
+        static int getLowerLane(int unison) { return 2 * unison + 2; }
+
+        /// @brief Converts a number of cycles to a phase accumulator value. Whole cycles are dropped
+        static uint32_t cyclesToPhase(double cycles)
+        {
+            return (uint32_t)(uint64_t)( ( cycles - std::floor(cycles) ) * 4294967296.0 );
+        }
+    };
+
+    /// @brief Renders every active oscillator lane of a voice and adds the gain-weighted sum to the outputs.
+    /// The table index is the top bits of the phase and the interpolation fraction the bits below it, so the inner loop has no wrapping branches or float to index conversions.
+    /// Phase increments and interpolation run on whole SIMD registers; only the table reads are done lane by lane
+    /// @param data The oscillator state of the voice
+    /// @param table The mipmap level to read
+    /// @param outputs The channel pointers the samples are added to
+    /// @param numSamples The number of samples to render
+    /// @param numChannels The number of channels to render. With 1, only the phases of the first channel are advanced
+    inline void renderOscillators(VoiceAngleData& data, const Wavetable& table, float* const* outputs, int numSamples, int numChannels = 2)
+    {
+        const int registers = ( data.activeLanes + SIMD_WIDTH - 1 ) / SIMD_WIDTH;
+        const int lanes = registers * SIMD_WIDTH;
+
+        const float* samples = table.getData();
+        const int indexBits = table.getSizeBits();
+        const int indexShift = 32 - indexBits;
+        constexpr float fractionScale = 1.f / (float)(1 << 24);
+
+        alignas(32) float fraction[OSCILLATOR_LANES];
+        alignas(32) float lower[OSCILLATOR_LANES];
+        alignas(32) float upper[OSCILLATOR_LANES];
+
+        for (int sample = 0; sample < numSamples; sample++)
+        {
+            for (int channel = 0; channel < numChannels; channel++)
+            {
+                uint32_t* phases = data.phase[channel];
+
+                for (int lane = 0; lane < lanes; lane++)
+                {
+                    const uint32_t phase = phases[lane];
+                    const auto index = (uint32_t)( (uint64_t)phase >> indexShift );
+
+                    fraction[lane] = (float)( (uint32_t)( (uint64_t)phase << indexBits ) >> 8 ) * fractionScale;
+                    lower[lane] = samples[index];
+                    upper[lane] = samples[index + 1];
+                }
+
+                auto sum = SIMDFloat::expand(0.f);
+                for (int i = 0; i < lanes; i += SIMD_WIDTH)
+                {
+                    ( SIMDPhase::fromRawArray(phases + i) + SIMDPhase::fromRawArray(data.phaseIncrement + i) ).copyToRawArray(phases + i);
+
+                    auto low = SIMDFloat::fromRawArray(lower + i);
+                    auto high = SIMDFloat::fromRawArray(upper + i);
+                    auto interpolated = SIMDFloat::multiplyAdd(low, SIMDFloat::fromRawArray(fraction + i), high - low);
+
+                    sum = SIMDFloat::multiplyAdd(sum, SIMDFloat::fromRawArray(data.gain + i), interpolated);
+                }
+
+                outputs[channel][sample] += sum.sum();
+            }
+        }
+    }
+}
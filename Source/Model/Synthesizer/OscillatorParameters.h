@@ -11,65 +11,49 @@
 #pragma once
 
 #include <JuceHeader.h>
-#include "../../Utils/WorkerThread.h"
-#include "../../Utils/TripleBuffer.h"
+#include "../../Utils/CoalescingWorker.h"
+#include "../../Utils/EpochPointer.h"
+#include "Wavetable.h"
+#include "WavetableGenerator.h"
+#include "WavetableSet.h"
+#include "WavetableCache.h"
+#include "WavetableFile.h"
+#include "SineBankKernel.h"
+#include "../ParameterRegistry.h"
 
 namespace Processor::Synthesizer
 {
-    constexpr int HARMONIC_N = 256;                         //The number of harmonics the oscillator uses
-    constexpr int LOOKUP_POINTS = 64 * HARMONIC_N;          //The number of calculated points in the lookup table
-    const int LOOKUP_SIZE = ceil(log2(HARMONIC_N) + 1);     //The number of mipmaps that need to be generated to avoid aliasing at a given harmonic count
+    constexpr uint32_t FALLBACK_LEVEL = 1u << (LOOKUP_SIZE - 1);   //The level with only the fundamental, always built so a voice has something to play until its own level is ready
 
-    struct OscillatorParameters : public juce::AudioProcessorValueTreeState::Listener,
-                                  public juce::Timer
+    struct OscillatorParameters
     {
     public:
-        OscillatorParameters(juce::AudioProcessorValueTreeState& apvts) : apvts(apvts)
+        OscillatorParameters(juce::AudioProcessorValueTreeState& apvts, ParameterRegistry& registry) : apvts(apvts), registry(registry)
         {
-            for(int i = 0; i < LOOKUP_SIZE; i++)
-            {
-                mipMap.add(std::make_unique<Utils::TripleBuffer<juce::dsp::LookupTableTransform<float>>>());
-                auto& mipMapInstance = mipMap[i]->write();
-                mipMapInstance.initialise([] (float x) { return 0; },
-                        0,
-                        juce::MathConstants<float>::twoPi,
-                        2);
-                mipMap[i]->release();
-            }
-
-            registerListener(this);
             linkParameters();
-
-            startTimer(10);
         }
 
-        ~OscillatorParameters() override
+        ~OscillatorParameters()
         {
-            removeListener(this);
-            lutUpdater.stopThread(10);
+            registry.removeListener(this);
         }
 
         void registerListener(juce::AudioProcessorValueTreeState::Listener* listener) const
         {
-            auto paramLayoutSchema = createParameterLayout();
-
-            auto params = paramLayoutSchema->getParameters(false);
-            for ( auto param : params )
+            //The gains and phases of the partials are two neighbouring ranges of the id table
+            const auto& ids = ParameterRegistry::getParameterIDTable();
+            for(int i = ParameterIndex::partialGain; i < ParameterIndex::eqBandGain; i++)
             {
-                auto id = dynamic_cast<juce::RangedAudioParameter*>(param)->getParameterID();
-                apvts.addParameterListener(id, listener);
+                apvts.addParameterListener(ids[(size_t)i], listener);
             }
         }
 
         void removeListener(juce::AudioProcessorValueTreeState::Listener* listener) const
         {
-            auto paramLayoutSchema = createParameterLayout();
-            auto params = paramLayoutSchema->getParameters(false);
-
-            for(auto param : params)
+            const auto& ids = ParameterRegistry::getParameterIDTable();
+            for(int i = ParameterIndex::partialGain; i < ParameterIndex::eqBandGain; i++)
             {
-                auto id = dynamic_cast<juce::RangedAudioParameter*>(param)->getParameterID();
-                apvts.removeParameterListener(id, listener);
+                apvts.removeParameterListener(ids[(size_t)i], listener);
             }
         }
 
@@ -110,17 +94,17 @@ namespace Processor::Synthesizer
         /// @brief Used for making the parameter ids of the the partials' gain parameters consistent
         /// @param index The index of the harmonic
         /// @return A parameter id
-        static const juce::String getPartialGainParameterID(size_t index)
+        static const juce::String& getPartialGainParameterID(size_t index)
         {
-            return "partial" + juce::String(index) + "gain";
+            return ParameterRegistry::getParameterID(ParameterIndex::partialGain + (int)index);
         }
 
         /// @brief Used for making the parameter ids of the the partials' phase parameters consistent
         /// @param index The index of the harmonic
         /// @return A parameter id
-        static const juce::String getPartialPhaseParameterID(size_t index)
+        static const juce::String& getPartialPhaseParameterID(size_t index)
         {
-            return "partial" + juce::String(index) + "phase";
+            return ParameterRegistry::getParameterID(ParameterIndex::partialPhase + (int)index);
         }
 
         /// @brief Generates a sample of the waveform defined by the parameters of the oscillator.
@@ -146,103 +130,214 @@ namespace Processor::Synthesizer
             return sample;
         }
 
-        /// @brief Calculates the peak amplitude of the waveform stored in the lookup table
-        /// @return The peak amplitude
-        const float getPeakAmplitude() const
+        /// @brief Sets the gain and phase of every partial as one edit. Message thread only.
+        /// Only the partials that change are sent to the host, inside one gesture for the whole edit, and the lookup table is rebuilt once after every value is set
+        /// @param gains The gains of the partials, normalised to 0..1 like the host sees them
+        /// @param phases The phases of the partials, normalised to 0..1 like the host sees them
+        void applyPartialSpectrum(const std::array<float, HARMONIC_N>& gains, const std::array<float, HARMONIC_N>& phases)
         {
-            float peakAmplitude = 0.f;
-            for(int i = 0; i < LOOKUP_POINTS; i++)  //Finding the peak amplitude of the lut
+            JUCE_ASSERT_MESSAGE_THREAD
+
+            std::vector<std::pair<juce::RangedAudioParameter*, float>> changes;
+            changes.reserve(2 * HARMONIC_N);
+
+            auto addChange = [&] (int parameterIndex, float newValue)
             {
-                float sample = getSample( juce::jmap( (float)i, 0.f, LOOKUP_POINTS-1.f, 0.f, juce::MathConstants<float>::twoPi), HARMONIC_N);
+                auto* parameter = registry.getParameter(parameterIndex);
+                if( parameter->getValue() != parameter->convertTo0to1(parameter->convertFrom0to1(newValue)) )
+                    changes.emplace_back(parameter, newValue);
+            };
 
-                if( std::fabs(sample) > peakAmplitude)
-                {
-                    peakAmplitude = std::fabs(sample);
-                }
+            for(int i = 0; i < HARMONIC_N; i++)
+            {
+                addChange(ParameterIndex::partialGain + i, gains[i]);
+                addChange(ParameterIndex::partialPhase + i, phases[i]);
             }
 
-            return peakAmplitude;
+            if( changes.empty() )
+                return;
+
+            //The registry still stores every value, only the rebuild is held back until the whole spectrum is in place
+            applyingSpectrum = true;
+
+            for(auto& [parameter, newValue] : changes)
+                parameter->beginChangeGesture();
+            for(auto& [parameter, newValue] : changes)
+                parameter->setValueNotifyingHost(newValue);
+            for(auto& [parameter, newValue] : changes)
+                parameter->endChangeGesture();
+
+            applyingSpectrum = false;
+
+            lutUpdater.request();
+        }
+
+        /// @brief The mipmap levels and the partial spectrum of the waveform, published as one set. Only the audio thread may read it
+        const Utils::EpochPointer<WavetableSet, WavetableSet::SharedPtr>& getWavetables() const
+        {
+            return wavetables;
+        }
+
+        /// @brief Stores the current waveform in the disk cache on the worker thread, so the next session can map it instead of building it again.
+        /// Hosts save the state often, so this never makes a rebuild stale: the missing levels are built after the ones the voices asked for are published
+        void requestWavetableSave()
+        {
+            saveRequested = true;
+            lutUpdater.requestFollowUp();
         }
 
-        const juce::OwnedArray<Utils::TripleBuffer<juce::dsp::LookupTableTransform<float>>>& getLookupTable() const
+        /// @brief Called by the audio thread after a block. Wakes the worker if voices asked for levels of the set that aren't built yet, without blocking
+        void requestMissingLevels(const WavetableSet& set)
         {
-            return mipMap;
+            if(set.getMissingLevels() != 0)
+                lutUpdater.requestFollowUp();
         }
 
+        /// @return The time from the first partial change of the last burst until its lookup table was published, in milliseconds
+        double getLastUpdateLatencyMs() const { return lutUpdater.getLastLatencyMs(); }
+
+        /// @return The longest edit-to-publish time measured since the plugin was loaded, in milliseconds
+        double getMaxUpdateLatencyMs() const { return lutUpdater.getMaxLatencyMs(); }
+
         std::array<const std::atomic<float>*, HARMONIC_N> partialGains;
         std::array<const std::atomic<float>*, HARMONIC_N> partialPhases;
     private:
         juce::AudioProcessorValueTreeState& apvts;
-        std::unordered_map<juce::String, std::atomic<float>> paramMap;
+        ParameterRegistry& registry;
 
-        juce::OwnedArray<Utils::TripleBuffer<juce::dsp::LookupTableTransform<float>>> mipMap;
-        Utils::WorkerThread lutUpdater { [&] () { updateLookupTable(); } };
-        std::atomic<bool> needUpdate = { false };
+        Utils::EpochPointer<WavetableSet, WavetableSet::SharedPtr> wavetables { WavetableSet::createSilent() };
+        WavetableGenerator generator;
+        juce::SharedResourcePointer<WavetableCache> cache;
+        std::atomic<bool> saveRequested = { false };       //Set by requestWavetableSave until the worker takes it over
+        std::optional<SpectrumKey> pendingSave;             //The waveform that was current when the state was saved, until it is written. Only touched by the worker
+        Utils::CoalescingWorker lutUpdater { "Wavetable Updater", [&] () { updateLookupTable(); } };
+        std::atomic<bool> applyingSpectrum = { false };    //Set while applyPartialSpectrum sets the parameters
 
-        void parameterChanged(const juce::String &parameterID, float newValue) override
+        void linkParameters()
         {
-            paramMap[parameterID] = newValue;
-            needUpdate = true;
+            for(int i = 0; i < HARMONIC_N; i++)
+            {
+                partialGains[i] = &registry[ParameterIndex::partialGain + i];
+                partialPhases[i] = &registry[ParameterIndex::partialPhase + i];
+            }
+
+            //The gains and phases of the partials are two neighbouring ranges of the registry. Host automation can call this on the audio thread, the request never blocks it
+            registry.addListener(this, ParameterIndex::partialGain, ParameterIndex::eqBandGain, [this] (int, float)
+            {
+                if( !applyingSpectrum )
+                    lutUpdater.request();
+            });
         }
 
-        void timerCallback() override
+        /// @brief Generates the lookup table with the current parameters. Only the levels the voices asked for are built, the others when a voice first needs them
+        void updateLookupTable()
         {
-            if (!lutUpdater.isThreadRunning() && needUpdate)
+            std::array<float, HARMONIC_N> gains;
+            std::array<float, HARMONIC_N> phases;
+            for(int i = 0; i < HARMONIC_N; i++)
+            {
+                gains[i] = partialGains[i]->load() / 100;
+                phases[i] = partialPhases[i]->load() / 100;
+            }
+
+            const SpectrumKey key(gains, phases);
+            const auto diskDirectory = cache->getDiskCacheDirectory();
+            const auto& latest = wavetables.getLatest();
+
+            //Another instance, or this one earlier, already built this waveform, or an earlier session stored it on disk
+            auto set = cache->find(key);
+            if(set == nullptr)
             {
-                lutUpdater.startThread();
-                needUpdate = false;
+                if(auto mapped = WavetableFile::load(diskDirectory, key))
+                    set = cache->insert(key, std::move(mapped));
+            }
+
+            if(set == nullptr)
+                set = createWavetables(key, gains, phases);
+
+            if(set == nullptr)
+            {   //Newer partials arrived, the worker starts over with them
+                return;
             }
+
+            //The notes that are playing keep using the levels they used with the previous set, and the last level is always there to fall back to
+            set->demandLevels(latest->getDemandedLevels() | FALLBACK_LEVEL);
+
+            if(saveRequested.exchange(false))
+                pendingSave = key;
+
+            if(!fillLevels(*set, gains, phases, set->getDemandedLevels()))
+                return;
+
+            //The spectrum and its levels are swapped in at once, the set the audio thread may still be reading is released by a later publish
+            if(set != latest)
+                wavetables.publish(set);
+
+            saveWavetables(key, gains, phases, *set, diskDirectory);
         }
 
-        void linkParameters()
+        /// @brief Builds the levels no voice asked for yet and stores the set, if it is the waveform that was current when the state was saved.
+        /// Runs after the demanded levels are published, so a save never holds back an edit. An edit to another waveform drops the save, the saved state no longer holds it
+        void saveWavetables(const SpectrumKey& key, const std::array<float, HARMONIC_N>& gains, const std::array<float, HARMONIC_N>& phases, WavetableSet& set, const juce::File& diskDirectory)
         {
-            auto paramLayoutSchema = createParameterLayout();
+            if(!pendingSave)
+                return;
 
-            auto params = paramLayoutSchema->getParameters(false);
-            for ( auto param : params )
+            if(*pendingSave != key)
             {
-                auto id = dynamic_cast<juce::RangedAudioParameter*>(param)->getParameterID();
-                auto value = dynamic_cast<juce::RangedAudioParameter*>(param)->getNormalisableRange().convertFrom0to1(param->getDefaultValue());
-                paramMap.emplace(id, value);
+                pendingSave.reset();
+                return;
             }
 
-            for(int i = 0; i < HARMONIC_N; i++)
-            {
-                partialGains[i] = &paramMap[getPartialGainParameterID(i)];
-                partialPhases[i] = &paramMap[getPartialPhaseParameterID(i)];
+            //Newer partials stop the build, the save is picked up again if the waveform comes back before another one is built
+            if(!fillLevels(set, gains, phases, ALL_LEVELS))
+                return;
+
+            if(set.isComplete())
+            {   //Only complete sets are stored, a mapped set can't be filled in later
+                pendingSave.reset();
+                WavetableFile::save(diskDirectory, key, set);
             }
         }
 
-        /// @brief Generates the lookup table with the current parameters
-        void updateLookupTable()
+        /// @brief Creates and caches an empty set for the spectrum
+        /// @return The new set, or nullptr if the generator gave up because newer partials arrived
+        WavetableSet::SharedPtr createWavetables(const SpectrumKey& key, const std::array<float, HARMONIC_N>& gains, const std::array<float, HARMONIC_N>& phases)
         {
-            float peakAmplitude = getPeakAmplitude();
+            auto generated = generator.update(gains, phases, 0, [&] () { return lutUpdater.isStale(); });
+            if(!generated)
+                return nullptr;
 
-            float gainToNormalize;
-            for(int i = 0; i < LOOKUP_SIZE; i++)    //Generating peak-normalized lookup table
+            const float gainToNormalize = *generated;
+            return cache->insert(key, WavetableSet::create(gainToNormalize, PartialSpectrum::fromPartials(gains, phases, gainToNormalize)));
+        }
+
+        /// @brief Builds the wanted levels of the set that no other instance is building. The ones voices asked for come first, the cheapest of them first, and each is ready as soon as it is filled
+        /// @return False if the generator gave up because newer partials arrived
+        bool fillLevels(WavetableSet& set, const std::array<float, HARMONIC_N>& gains, const std::array<float, HARMONIC_N>& phases, uint32_t wantedLevels)
+        {
+            uint32_t claimed = set.claimLevels(wantedLevels);
+            const uint32_t demanded = set.getDemandedLevels();
+
+            for(uint32_t priority : { demanded, ~demanded })
             {
-                if(peakAmplitude > 0.f)
-                {
-                    gainToNormalize = 1.f / peakAmplitude;
-                    auto& localMipMap = mipMap[i]->write();
-                    localMipMap.initialise(
-                        [this, i, gainToNormalize] (float x) { return gainToNormalize * getSample( x, std::floor( HARMONIC_N / pow(2, i) ) ); },
-                        0,
-                        juce::MathConstants<float>::twoPi,
-                        LOOKUP_POINTS / pow(2, i) + 1);
-                    mipMap[i]->release();
-                }
-                else
+                for(int level = LOOKUP_SIZE - 1; level >= 0; level--)
                 {
-                    auto& localMipMap = mipMap[i]->write();
-                    localMipMap.initialise(
-                        [] (float x) { return 0; },
-                        0,
-                        juce::MathConstants<float>::twoPi,
-                        2);
-                    mipMap[i]->release();
+                    const uint32_t bit = 1u << level;
+                    if((claimed & priority & bit) == 0)
+                        continue;
+
+                    if(!generator.update(gains, phases, bit, [&] () { return lutUpdater.isStale(); }))
+                    {
+                        set.releaseLevels(claimed);
+                        return false;
+                    }
+
+                    set.fillLevel(level, generator.getLevel(level));
+                    claimed &= ~bit;
                 }
             }
+            return true;
         }
 
         JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(OscillatorParameters)
@@ -0,0 +1,303 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "OscillatorKernel.h"
+
+namespace Processor::Synthesizer
+{
+    constexpr int SPARSE_MAX_PARTIALS = 16;                 //The highest number of nonzero partials the sparse sine bank engine renders
+    constexpr int SINE_BANK_CHUNK = 64;                     //The number of samples the sine bank keeps its accumulators for at once
+    constexpr int PARTIAL_GROUPS = 9;                       //The partials are grouped by octave for their envelopes: 1, 2-3, 4-7, ..., 128-255, 256
+    constexpr float PARTIAL_SILENCE = 1.0e-6f;              //Registers of partials whose amplitudes stay below this are skipped
+
+    static_assert(SPARSE_MAX_PARTIALS % SIMD_WIDTH == 0 && HARMONIC_N % SIMD_WIDTH == 0, "The partials of a lane have to fill whole SIMD registers");
+    static_assert(1 << ( PARTIAL_GROUPS - 1 ) == HARMONIC_N, "The last octave group has to hold the highest harmonic");
+
+    //Rough per-sample costs of the two engines, in units of one SIMD multiply-add
+    constexpr float TABLE_READ_COST = 4.f;                  //Index and fraction of one lane, and its two table reads
+    constexpr float TABLE_REGISTER_COST = 3.f;              //Phase increment, interpolation and accumulation of one register of lanes
+    constexpr float TABLE_CACHE_MISS_COST = 4.f;            //Extra cost of a table read once the levels played by the voices no longer fit in the cache
+    constexpr int TABLE_CACHED_VOICES = 8;                  //The number of voices whose table levels are assumed to fit in the cache
+    constexpr float ROTATION_REGISTER_COST = 4.f;           //Rotating and accumulating one register of partials of one lane
+
+    /// @brief The nonzero partials of the oscillator in ascending order
+    struct PartialSpectrum
+    {
+        int count = 0;
+        std::array<int, HARMONIC_N> harmonics {};           //The harmonic number of each partial, 1 being the fundamental
+        std::array<float, HARMONIC_N> gains {};             //The peak-normalised linear gain of each partial
+        std::array<double, HARMONIC_N> phaseSine {};        //The sine and cosine of each partial's phase
+        std::array<double, HARMONIC_N> phaseCosine {};
+
+        /// @brief Collects the nonzero partials of the oscillator, peak-normalised. Empty if the waveform is silent
+        /// @param gains The linear gains of the partials
+        /// @param phases The phases of the partials, as a proportion of 2 * pi radians
+        static PartialSpectrum fromPartials(const std::array<float, HARMONIC_N>& gains, const std::array<float, HARMONIC_N>& phases, float gainToNormalize)
+        {
+            PartialSpectrum spectrum;
+            for(int i = 0; i < HARMONIC_N; i++)
+            {
+                if(gains[i] != 0.f && gainToNormalize > 0.f)
+                {
+                    const int partial = spectrum.count++;
+                    spectrum.harmonics[partial] = i + 1;
+                    spectrum.gains[partial] = gains[i] * gainToNormalize;
+                    spectrum.phaseSine[partial] = std::sin(phases[i] * juce::MathConstants<double>::twoPi);
+                    spectrum.phaseCosine[partial] = std::cos(phases[i] * juce::MathConstants<double>::twoPi);
+                }
+            }
+            return spectrum;
+        }
+
+        bool isSparse() const { return count <= SPARSE_MAX_PARTIALS; }
+
+        /// @brief The octave group of a partial, used for the per-partial envelopes
+        int getGroup(int partial) const { return juce::findHighestSetBit((uint32_t)harmonics[partial]); }
+    };
+
+    enum class OscillatorEngine
+    {
+        wavetable,
+        sineBank,
+        partialBank
+    };
+
+    /// @brief Picks the cheaper engine for one voice. The wavetable engine pads the lanes to whole registers and reads the table lane by lane,
+    /// the sine bank rotates every partial of every lane, so which one wins depends on the number of partials, the number of unison lanes and how many voices compete for the cache
+    /// @param partials The number of nonzero partials
+    /// @param activeLanes The number of oscillator lanes the voice plays
+    /// @param voices The number of voices that play at the same time
+    inline OscillatorEngine chooseOscillatorEngine(int partials, int activeLanes, int voices)
+    {
+        if(partials > SPARSE_MAX_PARTIALS)
+        {
+            return OscillatorEngine::wavetable;
+        }
+
+        const int laneRegisters = ( activeLanes + SIMD_WIDTH - 1 ) / SIMD_WIDTH;
+        const int partialRegisters = ( partials + SIMD_WIDTH - 1 ) / SIMD_WIDTH;
+
+        const float readCost = TABLE_READ_COST + ( voices > TABLE_CACHED_VOICES ? TABLE_CACHE_MISS_COST : 0.f );
+        const float wavetableCost = laneRegisters * ( SIMD_WIDTH * readCost + TABLE_REGISTER_COST );
+        const float sineBankCost = activeLanes * partialRegisters * ROTATION_REGISTER_COST;
+
+        return sineBankCost < wavetableCost ? OscillatorEngine::sineBank : OscillatorEngine::wavetable;
+    }
+
+    /// @brief The state of a voice's recursive sine oscillators. Every lane has one oscillator per partial, rotated by a fixed angle every sample.
+    /// The amplitudes are per partial and shared by the lanes, they ramp linearly over each rendered block
+    template <int MaxPartials>
+    struct SineBankData
+    {
+        static constexpr int maxRegisters = MaxPartials / SIMD_WIDTH;
+
+        alignas(32) float sine[2][OSCILLATOR_LANES][MaxPartials] {};
+        alignas(32) float cosine[2][OSCILLATOR_LANES][MaxPartials] {};
+        alignas(32) float rotationSine[OSCILLATOR_LANES][MaxPartials] {};
+        alignas(32) float rotationCosine[OSCILLATOR_LANES][MaxPartials] {};
+        alignas(32) float amplitude[MaxPartials] {};
+        alignas(32) float amplitudeStep[MaxPartials] {};
+        alignas(32) float cutoffMask[OSCILLATOR_LANES][SIMD_WIDTH] {};  //Silences the partials of a lane's last register that would reach the Nyquist frequency
+
+        int laneRegisters[OSCILLATOR_LANES] {};             //The number of registers with partials below the Nyquist frequency in each lane
+        bool silentRegister[maxRegisters] {};
+        int partialRegisters = 0;
+    };
+
+    /// @brief Sets up the sine oscillators of a voice from its phase accumulators, so the sine bank continues exactly where the wavetable engine would be.
+    /// The harmonics' phases and rotations are stepped up from the fundamental's with complex multiplications in double precision, so only the fundamental needs trigonometry.
+    /// Partials that would reach the Nyquist frequency in a lane are culled from that lane
+    /// @param bank The sine bank state to set up
+    /// @param data The oscillator state of the voice
+    /// @param spectrum The partials to play, at most MaxPartials of them
+    /// @param numChannels The number of channels the voice renders
+    template <int MaxPartials>
+    void seedSineBank(SineBankData<MaxPartials>& bank, const VoiceAngleData& data, const PartialSpectrum& spectrum, int numChannels)
+    {
+        jassert(spectrum.count <= MaxPartials);
+
+        using Complex = std::complex<double>;
+        constexpr double phaseToRadians = juce::MathConstants<double>::twoPi / 4294967296.0;
+
+        bank.partialRegisters = ( spectrum.count + SIMD_WIDTH - 1 ) / SIMD_WIDTH;
+
+        for (int lane = 0; lane < data.activeLanes; lane++)
+        {
+            const Complex baseRotation = std::polar(1.0, (double)data.phaseIncrement[lane] * phaseToRadians);
+            Complex basePhase[2];
+            Complex harmonicPhase[2];
+            for (int channel = 0; channel < numChannels; channel++)
+            {
+                basePhase[channel] = std::polar(1.0, (double)data.phase[channel][lane] * phaseToRadians);
+                harmonicPhase[channel] = 1.0;
+            }
+            Complex harmonicRotation = 1.0;
+
+            int audible = 0;
+            int harmonic = 0;
+            for (; audible < spectrum.count; audible++)
+            {
+                const int target = spectrum.harmonics[audible];
+                if( (uint64_t)target * data.phaseIncrement[lane] >= ( (uint64_t)1 << 31 ) )
+                {   //The partials are in ascending order, none of the remaining ones fit below the Nyquist frequency
+                    break;
+                }
+
+                for (; harmonic < target; harmonic++)
+                {
+                    harmonicRotation *= baseRotation;
+                    for (int channel = 0; channel < numChannels; channel++)
+                    {
+                        harmonicPhase[channel] *= basePhase[channel];
+                    }
+                }
+
+                bank.rotationSine[lane][audible] = (float)harmonicRotation.imag();
+                bank.rotationCosine[lane][audible] = (float)harmonicRotation.real();
+
+                const Complex partialPhase { spectrum.phaseCosine[audible], spectrum.phaseSine[audible] };
+                for (int channel = 0; channel < numChannels; channel++)
+                {
+                    const auto phase = harmonicPhase[channel] * partialPhase;
+                    bank.sine[channel][lane][audible] = (float)phase.imag();
+                    bank.cosine[channel][lane][audible] = (float)phase.real();
+                }
+            }
+
+            bank.laneRegisters[lane] = ( audible + SIMD_WIDTH - 1 ) / SIMD_WIDTH;
+
+            const int lastRegisterStart = juce::jmax(0, bank.laneRegisters[lane] - 1) * SIMD_WIDTH;
+            for (int i = 0; i < SIMD_WIDTH; i++)
+            {
+                bank.cutoffMask[lane][i] = lastRegisterStart + i < audible ? 1.f : 0.f;
+            }
+        }
+    }
+
+    /// @brief Sets the amplitudes of the partials at once
+    template <int MaxPartials>
+    void setSineBankAmplitudes(SineBankData<MaxPartials>& bank, const float* amplitudes, int count)
+    {
+        std::fill(std::begin(bank.amplitude), std::end(bank.amplitude), 0.f);
+        std::fill(std::begin(bank.amplitudeStep), std::end(bank.amplitudeStep), 0.f);
+        std::copy(amplitudes, amplitudes + count, bank.amplitude);
+
+        for (int i = 0; i < SineBankData<MaxPartials>::maxRegisters; i++)
+        {
+            const auto range = juce::FloatVectorOperations::findMinAndMax(bank.amplitude + i * SIMD_WIDTH, SIMD_WIDTH);
+            bank.silentRegister[i] = juce::jmax(-range.getStart(), range.getEnd()) < PARTIAL_SILENCE;
+        }
+    }
+
+    /// @brief Ramps the amplitudes of the partials from their current values to the given ones over the next rendered block.
+    /// Registers that stay silent during the ramp are skipped by the renderer, their oscillators are brought back in phase by the next seedSineBank call
+    template <int MaxPartials>
+    void rampSineBankAmplitudes(SineBankData<MaxPartials>& bank, const float* amplitudes, int count, int numSamples)
+    {
+        const float stepScale = 1.f / (float)numSamples;
+
+        for (int i = 0; i < MaxPartials; i++)
+        {
+            const float target = i < count ? amplitudes[i] : 0.f;
+            bank.amplitudeStep[i] = ( target - bank.amplitude[i] ) * stepScale;
+        }
+
+        for (int i = 0; i < SineBankData<MaxPartials>::maxRegisters; i++)
+        {
+            bool silent = true;
+            for (int partial = i * SIMD_WIDTH; partial < ( i + 1 ) * SIMD_WIDTH; partial++)
+            {
+                const float target = bank.amplitude[partial] + bank.amplitudeStep[partial] * (float)numSamples;
+                silent = silent && std::abs(bank.amplitude[partial]) < PARTIAL_SILENCE && std::abs(target) < PARTIAL_SILENCE;
+            }
+            bank.silentRegister[i] = silent;
+        }
+    }
+
+    /// @brief Renders a voice with its sine oscillators and adds the result to the outputs. Each register of partials stays in registers for a whole chunk of samples.
+    /// The phase accumulators of the voice are advanced as well, so the wavetable engine can take over at any block
+    /// @param bank The sine bank state set up by seedSineBank
+    /// @param data The oscillator state of the voice
+    /// @param outputs The channel pointers the samples are added to
+    /// @param numSamples The number of samples to render
+    /// @param numChannels The number of channels to render
+    template <int MaxPartials>
+    void renderSineBank(SineBankData<MaxPartials>& bank, VoiceAngleData& data, float* const* outputs, int numSamples, int numChannels)
+    {
+        SIMDFloat accumulators[SINE_BANK_CHUNK];
+
+        for (int start = 0; start < numSamples; start += SINE_BANK_CHUNK)
+        {
+            const int chunkSize = juce::jmin(SINE_BANK_CHUNK, numSamples - start);
+
+            for (int channel = 0; channel < numChannels; channel++)
+            {
+                std::fill(std::begin(accumulators), std::begin(accumulators) + chunkSize, SIMDFloat::expand(0.f));
+
+                for (int lane = 0; lane < data.activeLanes; lane++)
+                {
+                    if( data.gain[lane] == 0.f )
+                    {
+                        continue;
+                    }
+
+                    const auto laneGain = SIMDFloat::expand(data.gain[lane]);
+                    const int lastRegister = bank.laneRegisters[lane] - 1;
+
+                    for (int r = 0; r <= lastRegister; r++)
+                    {
+                        if( bank.silentRegister[r] )
+                        {
+                            continue;
+                        }
+
+                        const int i = r * SIMD_WIDTH;
+                        auto sine = SIMDFloat::fromRawArray(bank.sine[channel][lane] + i);
+                        auto cosine = SIMDFloat::fromRawArray(bank.cosine[channel][lane] + i);
+                        const auto rotationSine = SIMDFloat::fromRawArray(bank.rotationSine[lane] + i);
+                        const auto rotationCosine = SIMDFloat::fromRawArray(bank.rotationCosine[lane] + i);
+
+                        auto gain = laneGain;
+                        if( r == lastRegister )
+                        {
+                            gain = gain * SIMDFloat::fromRawArray(bank.cutoffMask[lane]);
+                        }
+                        const auto step = SIMDFloat::fromRawArray(bank.amplitudeStep + i) * gain;
+                        auto amplitude = SIMDFloat::multiplyAdd(SIMDFloat::fromRawArray(bank.amplitude + i), SIMDFloat::expand((float)start), SIMDFloat::fromRawArray(bank.amplitudeStep + i)) * gain;
+
+                        for (int sample = 0; sample < chunkSize; sample++)
+                        {
+                            accumulators[sample] = SIMDFloat::multiplyAdd(accumulators[sample], amplitude, sine);
+                            amplitude = amplitude + step;
+
+                            const auto nextSine = sine * rotationCosine + cosine * rotationSine;
+                            cosine = cosine * rotationCosine - sine * rotationSine;
+                            sine = nextSine;
+                        }
+
+                        sine.copyToRawArray(bank.sine[channel][lane] + i);
+                        cosine.copyToRawArray(bank.cosine[channel][lane] + i);
+                    }
+                }
+
+                for (int sample = 0; sample < chunkSize; sample++)
+                {
+                    outputs[channel][start + sample] += accumulators[sample].sum();
+                }
+            }
+        }
+
+        for (int i = 0; i < MaxPartials; i++)
+        {
+            bank.amplitude[i] += bank.amplitudeStep[i] * (float)numSamples;
+        }
+
+        for (int channel = 0; channel < numChannels; channel++)
+        {
+            for (int lane = 0; lane < data.activeLanes; lane++)
+            {
+                data.phase[channel][lane] += data.phaseIncrement[lane] * (uint32_t)numSamples;
+            }
+        }
+    }
+}
@@ -0,0 +1,275 @@
+#include "VoiceBankSynthesiser.h"
+
+namespace Processor::Synthesizer
+{
+    void VoiceBankSynthesiser::addAdditiveVoice(const SynthParameterValues& synthParams)
+    {
+        jassert(bankSize < SYNTH_MAX_VOICES);
+
+        synthParameters = &synthParams;
+
+        auto* voice = new AdditiveVoice(synthParams, oscillators[bankSize], envelopes[bankSize], cullThresholdGain);
+        bankVoices[bankSize++] = voice;
+        addVoice(voice);
+    }
+
+    void VoiceBankSynthesiser::setBlockWavetables(const WavetableSet* wavetables)
+    {
+        blockWavetables = wavetables;
+
+        for(int slot = 0; slot < bankSize; slot++)
+        {
+            bankVoices[slot]->setBlockWavetables(wavetables);
+        }
+    }
+
+    bool VoiceBankSynthesiser::hasActiveVoices() const
+    {
+        for(int slot = 0; slot < bankSize; slot++)
+        {
+            if( bankVoices[slot]->isVoiceActive() )
+                return true;
+        }
+        return false;
+    }
+
+    void VoiceBankSynthesiser::prepareVoiceBank(int maximumBlockSize)
+    {
+        renderPool.reset();
+        partialBanks.resize(SYNTH_MAX_VOICES);
+
+        for(int slot = 0; slot < bankSize; slot++)
+        {
+            bankVoices[slot]->prepare(maximumBlockSize);
+        }
+
+        const int numWorkers = juce::jmin(MAX_RENDER_WORKERS, juce::SystemStats::getNumCpus() - 1);
+        if( parallelRendering && numWorkers > 0 )
+        {
+            blockScratch.setSize(2 * SYNTH_MAX_VOICES, juce::jmax(maximumBlockSize, VOICE_BANK_BLOCK_SIZE));
+            renderPool = std::make_unique<Utils::RealtimeWorkerPool>(numWorkers, [this](int task)
+            {
+                const int slot = activeSlots[task];
+                renderSlot(slot, blockScratch.getWritePointer(2 * slot), blockScratch.getWritePointer(2 * slot + 1), parallelBlockSize);
+            });
+        }
+        else
+        {
+            blockScratch.setSize(0, 0);
+        }
+    }
+
+    void VoiceBankSynthesiser::renderVoices(juce::AudioBuffer<float>& outputAudio, int startSample, int numSamples)
+    {
+        if( batchRendering && outputAudio.getNumChannels() >= 2 )
+        {
+            renderBank(outputAudio, startSample, numSamples);
+        }
+        else
+        {
+            juce::Synthesiser::renderVoices(outputAudio, startSample, numSamples);
+        }
+    }
+
+    void VoiceBankSynthesiser::renderBank(juce::AudioBuffer<float>& outputAudio, int startSample, int numSamples)
+    {
+        int activeCount = 0;
+        for(int slot = 0; slot < bankSize; slot++)
+        {
+            if( auto* table = bankVoices[slot]->prepareBlock() )
+            {
+                blockTables[slot] = table;
+                slotChannels[slot] = monoOutput ? 1 : bankVoices[slot]->getRenderChannels();
+                activeSlots[activeCount++] = slot;
+            }
+        }
+
+        chooseEngines(activeCount);
+
+        if( parallelRendering && renderPool != nullptr && activeCount > 1 )
+        {
+            renderParallel(outputAudio, startSample, numSamples, activeCount);
+        }
+        else
+        {
+            for(int offset = 0; offset < numSamples; offset += VOICE_BANK_BLOCK_SIZE)
+            {   //Each stage runs over every active voice before the next one starts, so the state a stage reads for all voices stays in the cache together
+                const int subBlockSize = juce::jmin(VOICE_BANK_BLOCK_SIZE, numSamples - offset);
+
+                for(int i = 0; i < activeCount; i++)
+                {
+                    const int slot = activeSlots[i];
+                    renderSlotOscillators(slot, getScratchRows(slot).data(), subBlockSize);
+                }
+
+                for(int i = 0; i < activeCount; i++)
+                {
+                    const int slot = activeSlots[i];
+                    applySlotEnvelope(slot, getScratchRows(slot).data(), subBlockSize);
+                }
+
+                for(int i = 0; i < activeCount; i++)
+                {
+                    const int slot = activeSlots[i];
+                    const auto rows = getScratchRows(slot);
+                    mixSlot(outputAudio, slot, rows[0], rows[1], startSample + offset, subBlockSize);
+                }
+            }
+        }
+
+        for(int slot = 0; slot < bankSize; slot++)
+        {
+            bankVoices[slot]->finishBlock();
+        }
+    }
+
+    void VoiceBankSynthesiser::chooseEngines(int activeCount)
+    {
+        blockSpectrum = blockWavetables != nullptr ? &blockWavetables->getSpectrum() : nullptr;
+
+        const bool partialEnvelopes = blockSpectrum != nullptr && synthParameters != nullptr
+                                      && synthParameters->partialEngine > 0.5f && !partialBanks.empty();
+
+        for(int i = 0; i < activeCount; i++)
+        {
+            const int slot = activeSlots[i];
+            const bool wasPartialBank = slotEngines[slot] == OscillatorEngine::partialBank;    //Still the engine of the slot's previous block
+            slotEngines[slot] = OscillatorEngine::wavetable;
+
+            if( partialEnvelopes )
+            {
+                slotEngines[slot] = OscillatorEngine::partialBank;
+                seedSineBank(partialBanks[slot], oscillators[slot], *blockSpectrum, slotChannels[slot]);
+
+                if( oscillators[slot].elapsedSamples == 0 || !wasPartialBank )
+                {   //A new note, or one that was playing on another engine, starts from its envelopes' current level instead of ramping from what the bank last played
+                    alignas(32) float amplitudes[HARMONIC_N];
+                    getPartialEnvelopeAmplitudes(oscillators[slot].elapsedSamples, amplitudes);
+                    setSineBankAmplitudes(partialBanks[slot], amplitudes, blockSpectrum->count);
+                }
+            }
+            else if( blockSpectrum != nullptr && blockSpectrum->isSparse()
+                     && chooseOscillatorEngine(blockSpectrum->count, oscillators[slot].activeLanes, activeCount) == OscillatorEngine::sineBank )
+            {
+                slotEngines[slot] = OscillatorEngine::sineBank;
+                seedSineBank(sineBanks[slot], oscillators[slot], *blockSpectrum, slotChannels[slot]);
+                setSineBankAmplitudes(sineBanks[slot], blockSpectrum->gains.data(), blockSpectrum->count);
+            }
+        }
+    }
+
+    void VoiceBankSynthesiser::updatePartialEnvelopes(int slot, int numSamples)
+    {
+        alignas(32) float amplitudes[HARMONIC_N];
+        getPartialEnvelopeAmplitudes(oscillators[slot].elapsedSamples + numSamples, amplitudes);
+
+        rampSineBankAmplitudes(partialBanks[slot], amplitudes, blockSpectrum->count, numSamples);
+    }
+
+    void VoiceBankSynthesiser::getPartialEnvelopeAmplitudes(int64_t elapsedSamples, float* amplitudes) const
+    {
+        const double decaySamples = synthParameters->partialDecay / 1000 * getSampleRate();
+        const double tilt = 1 + synthParameters->partialDecayTilt / 100;
+        const float sustain = synthParameters->partialSustain / 100;
+        const double time = (double)elapsedSamples;
+
+        std::array<float, PARTIAL_GROUPS> groupLevels;
+        double groupDecay = decaySamples;
+        for(int group = 0; group < PARTIAL_GROUPS; group++)
+        {
+            groupLevels[group] = sustain + ( 1.f - sustain ) * (float)std::exp(-time / groupDecay);
+            groupDecay /= tilt;
+        }
+
+        for(int partial = 0; partial < blockSpectrum->count; partial++)
+        {
+            amplitudes[partial] = blockSpectrum->gains[partial] * groupLevels[blockSpectrum->getGroup(partial)];
+        }
+    }
+
+    void VoiceBankSynthesiser::renderParallel(juce::AudioBuffer<float>& outputAudio, int startSample, int numSamples, int activeCount)
+    {
+        const int capacity = blockScratch.getNumSamples();
+
+        for(int offset = 0; offset < numSamples; offset += capacity)
+        {
+            parallelBlockSize = juce::jmin(capacity, numSamples - offset);
+
+            renderPool->run(activeCount);
+
+            for(int i = 0; i < activeCount; i++)
+            {
+                const int slot = activeSlots[i];
+                mixSlot(outputAudio, slot, blockScratch.getReadPointer(2 * slot), blockScratch.getReadPointer(2 * slot + 1), startSample + offset, parallelBlockSize);
+            }
+        }
+    }
+
+    void VoiceBankSynthesiser::renderSlot(int slot, float* left, float* right, int numSamples)
+    {
+        for(int offset = 0; offset < numSamples; offset += VOICE_BANK_BLOCK_SIZE)
+        {
+            const int subBlockSize = juce::jmin(VOICE_BANK_BLOCK_SIZE, numSamples - offset);
+            float* subRows[2] = { left + offset, right + offset };
+
+            renderSlotOscillators(slot, subRows, subBlockSize);
+            applySlotEnvelope(slot, subRows, subBlockSize);
+        }
+    }
+
+    void VoiceBankSynthesiser::renderSlotOscillators(int slot, float* const* rows, int numSamples)
+    {
+        const int numChannels = slotChannels[slot];
+        for(int channel = 0; channel < numChannels; channel++)
+        {
+            juce::FloatVectorOperations::clear(rows[channel], numSamples);
+        }
+
+        switch (slotEngines[slot])
+        {
+            case OscillatorEngine::partialBank:
+                updatePartialEnvelopes(slot, numSamples);
+                renderSineBank(partialBanks[slot], oscillators[slot], rows, numSamples, numChannels);
+                break;
+            case OscillatorEngine::sineBank:
+                renderSineBank(sineBanks[slot], oscillators[slot], rows, numSamples, numChannels);
+                break;
+            default:
+                renderOscillators(oscillators[slot], *blockTables[slot], rows, numSamples, numChannels);
+                break;
+        }
+        oscillators[slot].elapsedSamples += numSamples;
+    }
+
+    void VoiceBankSynthesiser::applySlotEnvelope(int slot, float* const* rows, int numSamples)
+    {
+        auto& envelope = envelopes[slot];
+
+        if( slotChannels[slot] == 1 )
+        {
+            for(int sample = 0; sample < numSamples; sample++)
+            {
+                rows[0][sample] *= envelope.getNextSample();
+            }
+        }
+        else
+        {
+            for(int sample = 0; sample < numSamples; sample++)
+            {
+                const float envelopeGain = envelope.getNextSample();
+                rows[0][sample] *= envelopeGain;
+                rows[1][sample] *= envelopeGain;
+            }
+        }
+    }
+
+    void VoiceBankSynthesiser::mixSlot(juce::AudioBuffer<float>& outputAudio, int slot, const float* left, const float* right, int startSample, int numSamples)
+    {
+        outputAudio.addFrom(0, startSample, left, numSamples);
+
+        if( !monoOutput )
+        {
+            outputAudio.addFrom(1, startSample, slotChannels[slot] == 1 ? left : right, numSamples);
+        }
+    }
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "AdditiveVoice.h"
+#include "WavetableSet.h"
+#include "SineBankKernel.h"
+#include "../../Utils/RealtimeWorkerPool.h"
+
+namespace Processor::Synthesizer
+{
+    constexpr int VOICE_BANK_BLOCK_SIZE = 64;               //The number of samples the batched engine renders for every voice before moving to the next sub-block
+    constexpr int MAX_RENDER_WORKERS = 3;                   //The number of worker threads the parallel engine spawns at most, besides the audio thread
+
+    /// @brief A synthesiser that owns the oscillator and envelope state of all of its voices in contiguous arrays.
+    /// When batch rendering is enabled, every active voice is rendered in one loop per sub-block instead of through one virtual renderNextBlock call per voice
+    class VoiceBankSynthesiser : public juce::Synthesiser
+    {
+    public:
+        VoiceBankSynthesiser() = default;
+
+        /// @brief Creates a voice that keeps its state in the next free slot of the bank and adds it to the synthesiser
+        /// @param synthParams The parameter values of the current block, updated by the owner before every block
+        void addAdditiveVoice(const SynthParameterValues& synthParams);
+
+        /// @brief Sets the wavetables every voice renders the next block with. Their spectrum lets the bank render voices with the sine bank engine whenever the waveform has few enough partials for it to be cheaper,
+        /// and with the partial bank engine when the partial envelopes are turned on. The caller keeps the set alive until the block is rendered
+        void setBlockWavetables(const WavetableSet* wavetables);
+
+        /// @brief Allocates the buffers of the bank and its voices, and starts the render workers if parallel rendering is enabled. Must not be called while rendering
+        void prepareVoiceBank(int maximumBlockSize);
+
+        void setBatchRenderingEnabled(bool shouldBeEnabled) { batchRendering = shouldBeEnabled; }
+        bool isBatchRenderingEnabled() const { return batchRendering; }
+
+        /// @brief Renders every voice into the first channel only. The caller is expected to copy it to the other channel once stereo is needed
+        void setMonoOutputEnabled(bool shouldBeEnabled) { monoOutput = shouldBeEnabled; }
+        bool isMonoOutputEnabled() const { return monoOutput; }
+
+        /// @brief Enables splitting the active voices across a pool of real-time worker threads. The workers are started by the next prepareVoiceBank call
+        void setParallelRenderingEnabled(bool shouldBeEnabled) { parallelRendering = shouldBeEnabled; }
+        bool isParallelRenderingEnabled() const { return parallelRendering; }
+
+        /// @brief Sets the level below which decaying voices are faded out and freed instead of rendered until their release ends
+        /// @param decibels The threshold relative to the voice at full velocity, or minus infinity to render every release to the end
+        void setVoiceCullThreshold(float decibels) { cullThresholdGain = juce::Decibels::decibelsToGain(decibels, -std::numeric_limits<float>::infinity()); }
+
+        /// @return True if any voice is playing a note or still releasing one
+        bool hasActiveVoices() const;
+
+    protected:
+        void renderVoices(juce::AudioBuffer<float>& outputAudio, int startSample, int numSamples) override;
+
+    private:
+        std::array<VoiceAngleData, SYNTH_MAX_VOICES> oscillators;
+        std::array<VoiceEnvelope, SYNTH_MAX_VOICES> envelopes;
+        std::array<SineBankData<SPARSE_MAX_PARTIALS>, SYNTH_MAX_VOICES> sineBanks;
+        std::vector<SineBankData<HARMONIC_N>> partialBanks; //Large, so only allocated in prepareVoiceBank
+
+        std::array<AdditiveVoice*, SYNTH_MAX_VOICES> bankVoices {};
+        int bankSize = 0;
+
+        std::array<const Wavetable*, SYNTH_MAX_VOICES> blockTables {};  //The mipmap level each voice renders with in the current block
+        std::array<int, SYNTH_MAX_VOICES> activeSlots {};
+        std::array<int, SYNTH_MAX_VOICES> slotChannels {};              //The number of channels each voice renders in the current block
+        std::array<OscillatorEngine, SYNTH_MAX_VOICES> slotEngines {};  //The engine each voice renders with in the current block
+
+        const WavetableSet* blockWavetables = nullptr;      //The set every voice renders the current block with
+        const PartialSpectrum* blockSpectrum = nullptr;
+        const SynthParameterValues* synthParameters = nullptr;
+
+        juce::AudioBuffer<float> scratch { 2 * SYNTH_MAX_VOICES, VOICE_BANK_BLOCK_SIZE }; //Two rows per slot, sized for one sub-block
+        juce::AudioBuffer<float> blockScratch;              //Two rows per slot, sized for a whole block, written by the render workers
+
+        std::unique_ptr<Utils::RealtimeWorkerPool> renderPool;
+        int parallelBlockSize = 0;
+
+        std::atomic<bool> batchRendering { true };
+        std::atomic<bool> parallelRendering { false };
+        std::atomic<bool> monoOutput { false };
+        std::atomic<float> cullThresholdGain { juce::Decibels::decibelsToGain(VOICE_CULL_THRESHOLD_DB, -std::numeric_limits<float>::infinity()) };
+
+        /// @brief Renders every active voice of the bank with the batched engine. Every sub-block runs in stages, each over all active voices: the oscillators, then the envelopes, then the mix
+        void renderBank(juce::AudioBuffer<float>& outputAudio, int startSample, int numSamples);
+
+        /// @brief Picks the oscillator engine of every active voice for the current block, and sets up the sine banks of the voices that use it
+        void chooseEngines(int activeCount);
+
+        /// @brief Ramps the amplitudes of a partial bank voice to the values of the partial envelopes at the end of the next sub-block. The envelopes are evaluated once per octave group
+        void updatePartialEnvelopes(int slot, int numSamples);
+
+        /// @brief Evaluates the partial envelopes of a note at the given time, for every partial of the block's spectrum
+        void getPartialEnvelopeAmplitudes(int64_t elapsedSamples, float* amplitudes) const;
+
+        /// @brief Renders the active voices on the worker pool, each into its own rows of the block scratch, then sums them in slot order so the result doesn't depend on which thread rendered which voice
+        void renderParallel(juce::AudioBuffer<float>& outputAudio, int startSample, int numSamples, int activeCount);
+
+        /// @brief Renders the oscillators of one slot into the given rows and applies the slot's envelope, one sub-block at a time. Used by the render workers, which each own whole voices. Mono slots only write the left row
+        void renderSlot(int slot, float* left, float* right, int numSamples);
+
+        /// @brief The oscillator stage of one sub-block. Overwrites the rows of the slot with its oscillators' output
+        void renderSlotOscillators(int slot, float* const* rows, int numSamples);
+
+        /// @brief The envelope stage of one sub-block. Scales the rows of the slot by its amplitude envelope
+        void applySlotEnvelope(int slot, float* const* rows, int numSamples);
+
+        /// @return The two rows of the sub-block scratch that belong to the slot
+        std::array<float*, 2> getScratchRows(int slot) { return { scratch.getWritePointer(2 * slot), scratch.getWritePointer(2 * slot + 1) }; }
+
+        /// @brief Adds the rendered rows of one slot to the output. Mono slots are added to both channels, unless the output itself is mono
+        void mixSlot(juce::AudioBuffer<float>& outputAudio, int slot, const float* left, const float* right, int startSample, int numSamples);
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(VoiceBankSynthesiser)
+    };
+}
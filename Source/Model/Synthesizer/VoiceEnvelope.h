@@ -0,0 +1,87 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+namespace Processor::Synthesizer
+{
+    constexpr float VOICE_CULL_THRESHOLD_DB = -110.f;       //The default level below which a decaying voice is faded out instead of rendered until its release ends
+    constexpr double VOICE_CULL_FADE_SECONDS = 0.005;       //The length of the fade that cuts a culled voice off
+
+    /// @brief The amplitude envelope of a voice. Wraps a juce::ADSR, remembers the level it reached and can fade the voice out early once it has become inaudible
+    struct VoiceEnvelope
+    {
+        void setSampleRate(double sampleRate) { adsr.setSampleRate(sampleRate); }
+        void setParameters(const juce::ADSR::Parameters& parameters) { adsr.setParameters(parameters); }
+
+        void noteOn()
+        {
+            level = 0.f;
+            peakLevel = 0.f;
+            fadeGain = 1.f;
+            fadeStep = 0.f;
+            adsr.noteOn();
+        }
+
+        void noteOff() { adsr.noteOff(); }
+
+        void reset()
+        {
+            adsr.reset();
+            level = 0.f;
+            fadeGain = 1.f;
+            fadeStep = 0.f;
+        }
+
+        bool isActive() const noexcept { return adsr.isActive(); }
+        bool isFading() const noexcept { return fadeStep > 0.f; }
+
+        /// @return The gain of the next sample. Once a fade has reached silence the envelope ends
+        float getNextSample() noexcept
+        {
+            level = adsr.getNextSample();
+
+            if( fadeStep > 0.f )
+            {
+                fadeGain -= fadeStep;
+                if( fadeGain <= 0.f )
+                {
+                    reset();
+                    return 0.f;
+                }
+            }
+            return level * fadeGain;
+        }
+
+        void applyToBuffer(juce::AudioBuffer<float>& buffer, int startSample, int numSamples) noexcept
+        {
+            for(int sample = startSample; sample < startSample + numSamples; sample++)
+            {
+                const float gain = getNextSample();
+                for(int channel = 0; channel < buffer.getNumChannels(); channel++)
+                {
+                    buffer.getWritePointer(channel)[sample] *= gain;
+                }
+            }
+        }
+
+        /// @brief Starts fading out if the envelope has fallen from its peak to below the threshold. The attack never counts, it only rises. Called between blocks
+        /// @param thresholdGain The envelope level below which the voice can't be heard anymore. 0 never culls
+        /// @param fadeSamples The length of the fade
+        void cullBelow(float thresholdGain, int fadeSamples) noexcept
+        {
+            peakLevel = juce::jmax(peakLevel, level);
+
+            if( !isFading() && adsr.isActive() && level < peakLevel && level < thresholdGain )
+            {
+                fadeStep = 1.f / (float)juce::jmax(1, fadeSamples);
+            }
+        }
+
+    private:
+        juce::ADSR adsr;
+        float level = 0.f;                                  //The envelope's value at the last rendered sample
+        float peakLevel = 0.f;                              //The highest level seen at the end of a block since the note started
+        float fadeGain = 1.f;
+        float fadeStep = 0.f;                               //Subtracted from the fade gain every sample, 0 while not fading
+    };
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+namespace Processor::Synthesizer
+{
+    constexpr int HARMONIC_N = 256;                         //The number of harmonics the oscillator uses
+    constexpr int POINTS_PER_HARMONIC = 64;                 //The most points a mipmap level has for each harmonic it holds, the levels between octaves get fewer but above half of it
+    constexpr int LOOKUP_POINTS = POINTS_PER_HARMONIC * HARMONIC_N;     //The number of calculated points in the largest lookup table
+    constexpr int MIPMAP_STEPS_PER_OCTAVE = 3;              //The mipmap ladder loses a third of an octave of harmonics per level
+
+    /// @brief The harmonic count a third-octave step of the mipmap ladder would hold, rounded down but never below the fundamental
+    constexpr int getMipMapStepHarmonics(int step)
+    {
+        constexpr double stepRatios[MIPMAP_STEPS_PER_OCTAVE] { 1.0, 0.7937005259840998, 0.6299605249474366 };    //2^(-i/3)
+        const int octaveHarmonics = HARMONIC_N >> (step / MIPMAP_STEPS_PER_OCTAVE);
+        return std::max(1, (int)(octaveHarmonics * stepRatios[step % MIPMAP_STEPS_PER_OCTAVE]));
+    }
+
+    /// @brief Walks the ladder from every harmonic down to the fundamental alone, skipping the steps that round to the count of the one before
+    /// @param levelHarmonics Receives the harmonic count of each level, if given
+    /// @return The number of levels
+    constexpr int buildMipMapLadder(int* levelHarmonics = nullptr)
+    {
+        int levels = 0;
+        for(int step = 0, previous = HARMONIC_N + 1; previous > 1; step++)
+        {
+            const int harmonics = getMipMapStepHarmonics(step);
+            if(harmonics < previous)
+            {
+                if(levelHarmonics != nullptr)
+                    levelHarmonics[levels] = harmonics;
+
+                levels++;
+                previous = harmonics;
+            }
+        }
+        return levels;
+    }
+
+    constexpr int LOOKUP_SIZE = buildMipMapLadder();        //The number of mipmap levels
+    static_assert(LOOKUP_SIZE <= 32, "The levels of a set are tracked in 32 bit masks");
+
+    /// @brief The number of harmonics each mipmap level holds, from HARMONIC_N down to 1
+    constexpr std::array<int, LOOKUP_SIZE> MIPMAP_HARMONICS = [] ()
+    {
+        std::array<int, LOOKUP_SIZE> harmonics {};
+        buildMipMapLadder(harmonics.data());
+        return harmonics;
+    }();
+
+    /// @brief Finds the mipmap level with the most harmonics that all stay below the Nyquist frequency
+    /// @param highestFundamental The highest fundamental frequency the level is played at
+    /// @return The index of the level, or LOOKUP_SIZE if not even the fundamental is below the Nyquist frequency
+    inline int findMipMapLevel(double highestFundamental, double nyquistFrequency)
+    {
+        if(highestFundamental <= 0.0)
+            return 0;
+
+        //Harmonic k stays below Nyquist while k < allowedHarmonics. The ladder's spacing gives the level directly, the correction only covers the rounded counts
+        const double allowedHarmonics = nyquistFrequency / highestFundamental;
+        int level = (int)juce::jlimit(0.0, (double)LOOKUP_SIZE, MIPMAP_STEPS_PER_OCTAVE * std::log2(HARMONIC_N / allowedHarmonics));
+
+        while(level > 0 && MIPMAP_HARMONICS[level - 1] < allowedHarmonics)
+        {
+            level--;
+        }
+        while(level < LOOKUP_SIZE && MIPMAP_HARMONICS[level] >= allowedHarmonics)
+        {
+            level++;
+        }
+        return level;
+    }
+
+    /// @brief One cycle of a waveform, sampled at a power of two number of evenly spaced points over [0, 2pi). A copy of the first point is stored at the end, so interpolation never has to wrap around.
+    /// The table doesn't own its samples, they live in the WavetableSet it belongs to
+    struct Wavetable
+    {
+        /// @brief Creates a silent table
+        Wavetable() = default;
+
+        /// @param data The samples of the cycle, followed by a copy of the first one
+        /// @param numPoints The number of samples in the cycle, without the closing point. A power of two
+        Wavetable(const float* data, int numPoints) :
+            samples(data),
+            size(numPoints),
+            sizeBits(juce::roundToInt(std::log2(numPoints))),
+            scaler((float)numPoints / juce::MathConstants<float>::twoPi)
+        {
+            jassert(juce::isPowerOfTwo(numPoints));
+        }
+
+        /// @brief Reads the waveform at the given angle with linear interpolation
+        /// @param angle The angle to read at (in radians, [0..2pi])
+        /// @return The interpolated sample
+        float operator[](float angle) const noexcept
+        {
+            float position = juce::jlimit(0.f, (float)size, angle * scaler);
+            int index = juce::jmin((int)position, size - 1);
+            float fraction = position - (float)index;
+
+            return samples[index] + fraction * (samples[index + 1] - samples[index]);
+        }
+
+        int getSize() const noexcept { return size; }
+        int getSizeBits() const noexcept { return sizeBits; }
+        float getScaler() const noexcept { return scaler; }
+        const float* getData() const noexcept { return samples; }
+
+    private:
+        static constexpr float silence[2] {};
+
+        const float* samples = silence;
+        int size = 1;
+        int sizeBits = 0;                                   //The size is always a power of two, so phase accumulators can index the table with their top bits
+        float scaler = 1.f / juce::MathConstants<float>::twoPi;
+    };
+}
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <bit>
+#include "WavetableSet.h"
+
+namespace Processor::Synthesizer
+{
+    constexpr size_t WAVETABLE_CACHE_BUDGET = 32 * 1024 * 1024;    //The default number of bytes the cached wavetable sets may take up
+
+    /// @brief The exact partials a wavetable set is built from. Spectra only share a key if every gain and phase is the same float, so a cached set always holds the levels of the spectrum that asked for it
+    struct SpectrumKey
+    {
+        /// @param gains The linear gains of the partials
+        /// @param phases The phases of the partials, as a proportion of 2 * pi radians
+        SpectrumKey(const std::array<float, HARMONIC_N>& gains, const std::array<float, HARMONIC_N>& phases)
+        {
+            hash = 14695981039346656037ull;     //64 bit FNV-1a over the bits of the values
+            for(int i = 0; i < HARMONIC_N; i++)
+            {
+                values[2 * i] = toBits(gains[i]);
+                values[2 * i + 1] = toBits(phases[i]);
+
+                for(int j = 2 * i; j < 2 * i + 2; j++)
+                {
+                    hash = ( hash ^ values[j] ) * 1099511628211ull;
+                }
+            }
+        }
+
+        bool operator==(const SpectrumKey&) const = default;
+
+        /// @brief Decodes the gains and phases the key was made from
+        void getPartials(std::array<float, HARMONIC_N>& gains, std::array<float, HARMONIC_N>& phases) const
+        {
+            for(int i = 0; i < HARMONIC_N; i++)
+            {
+                gains[i] = std::bit_cast<float>(values[2 * i]);
+                phases[i] = std::bit_cast<float>(values[2 * i + 1]);
+            }
+        }
+
+        uint64_t hash = 0;
+        std::array<uint32_t, 2 * HARMONIC_N> values;        //The bits of the gain and phase of every partial, interleaved
+
+    private:
+        /// @brief The bits of the value, with -0 folded into 0 because both build the same waveform
+        static uint32_t toBits(float value)
+        {
+            return std::bit_cast<uint32_t>(value == 0.f ? 0.f : value);
+        }
+    };
+
+    /// @brief Wavetable sets shared by every instance of the plugin in the process, looked up by the spectrum they were built from.
+    /// Instances that play the same waveform hold the same read-only set. The least recently used sets are dropped once the cache grows past its budget,
+    /// the instances that still play them keep them alive. Held through a juce::SharedResourcePointer, safe to use from any thread except the audio thread
+    class WavetableCache
+    {
+    public:
+        WavetableCache() = default;
+
+        /// @brief The default folder of the disk cache, inside the user's application data folder
+        static juce::File getDefaultDiskCacheDirectory()
+        {
+            return juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+                       .getChildFile(JucePlugin_Manufacturer).getChildFile(JucePlugin_Name).getChildFile("Wavetables");
+        }
+
+        /// @brief Sets the folder the sets are stored in between sessions. The default juce::File turns the disk cache off
+        void setDiskCacheDirectory(const juce::File& directory)
+        {
+            const juce::ScopedLock lock(cacheLock);
+            diskDirectory = directory;
+        }
+
+        juce::File getDiskCacheDirectory() const
+        {
+            const juce::ScopedLock lock(cacheLock);
+            return diskDirectory;
+        }
+
+        /// @return The cached set built from the spectrum, or nullptr if there is none
+        WavetableSet::SharedPtr find(const SpectrumKey& key)
+        {
+            const juce::ScopedLock lock(cacheLock);
+
+            auto entry = index.find(key.hash);
+            if( entry == index.end() || entry->second->key != key )
+                return nullptr;
+
+            entries.splice(entries.begin(), entries, entry->second);    //Most recently used first
+            return entry->second->set;
+        }
+
+        /// @brief Adds a newly built set to the cache
+        /// @return The set to use. If another instance cached a set for the same spectrum in the meantime, that one is returned and the new one is dropped
+        WavetableSet::SharedPtr insert(const SpectrumKey& key, WavetableSet::SharedPtr set)
+        {
+            const juce::ScopedLock lock(cacheLock);
+
+            if( auto entry = index.find(key.hash); entry != index.end() )
+            {
+                if( entry->second->key == key )
+                {
+                    entries.splice(entries.begin(), entries, entry->second);
+                    return entry->second->set;
+                }
+
+                erase(entry->second);   //A hash collision, the newer spectrum takes its place
+            }
+
+            usedBytes += set->getSizeInBytes();
+            entries.push_front({ key, set });
+            index[key.hash] = entries.begin();
+
+            evict();
+            return set;
+        }
+
+        /// @brief Sets the number of bytes the cached sets may take up, and drops the least recently used ones that don't fit
+        void setMemoryBudget(size_t bytes)
+        {
+            const juce::ScopedLock lock(cacheLock);
+            budget = bytes;
+            evict();
+        }
+
+        size_t getMemoryUsage() const
+        {
+            const juce::ScopedLock lock(cacheLock);
+            return usedBytes;
+        }
+
+    private:
+        struct Entry
+        {
+            SpectrumKey key;
+            WavetableSet::SharedPtr set;
+        };
+
+        std::list<Entry> entries;                           //Most recently used first
+        std::unordered_map<uint64_t, std::list<Entry>::iterator> index;
+        size_t usedBytes = 0;
+        size_t budget = WAVETABLE_CACHE_BUDGET;
+        juce::File diskDirectory = getDefaultDiskCacheDirectory();
+        juce::CriticalSection cacheLock;
+
+        void erase(std::list<Entry>::iterator entry)
+        {
+            usedBytes -= entry->set->getSizeInBytes();
+            index.erase(entry->key.hash);
+            entries.erase(entry);
+        }
+
+        /// @brief Drops the least recently used sets until the cache fits its budget. The most recent one is always kept
+        void evict()
+        {
+            while( usedBytes > budget && entries.size() > 1 )
+            {
+                erase(std::prev(entries.end()));
+            }
+        }
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(WavetableCache)
+    };
+}
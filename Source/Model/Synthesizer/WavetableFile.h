@@ -0,0 +1,165 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "WavetableSet.h"
+#include "WavetableCache.h"
+
+namespace Processor::Synthesizer
+{
+    constexpr juce::int64 WAVETABLE_DISK_BUDGET = 64 * 1024 * 1024;    //The number of bytes the files of the disk cache may take up, the least recently used ones beyond it are deleted
+
+    /// @brief Stores wavetable sets in files, one per spectrum, and maps them back read-only. A loaded set reads its samples straight from the file's pages,
+    /// so nothing is computed or copied, and instances in different processes that load the same file share it through the OS page cache
+    struct WavetableFile
+    {
+        static constexpr uint32_t MAGIC = 0x54575356;       //"VSWT"
+        static constexpr uint32_t VERSION = 5;              //Increase whenever the generator's output or the layout of the file changes
+        static constexpr size_t SAMPLE_ALIGNMENT = 64;
+        static constexpr const char* FILE_EXTENSION = ".wavetables";
+
+        /// @brief Everything in front of the samples. The layout fields make files written by a build with different table sizes invalid
+        struct Header
+        {
+            uint32_t magic = MAGIC;
+            uint32_t version = VERSION;
+            uint64_t hash = 0;
+            int32_t harmonics = HARMONIC_N;
+            int32_t lookupPoints = LOOKUP_POINTS;
+            int32_t levels = LOOKUP_SIZE;
+            float gainToNormalize = 0.f;                    //The partial spectrum is rebuilt from the key and this gain, nothing the audio thread indexes with is read from the file
+            std::array<uint32_t, 2 * HARMONIC_N> keyValues {};   //The whole key, so a hash collision can't load the wrong waveform
+
+            /// @return False if the file was written by another version or with other table sizes, it can never be loaded by this build then. A damaged gain is caught too, a silent set is never stored
+            bool hasCurrentLayout() const
+            {
+                return magic == MAGIC && version == VERSION
+                       && harmonics == HARMONIC_N && lookupPoints == LOOKUP_POINTS && levels == LOOKUP_SIZE
+                       && std::isfinite(gainToNormalize) && gainToNormalize > 0.f;
+            }
+
+            bool holds(const SpectrumKey& key) const
+            {
+                return hash == key.hash && keyValues == key.values;
+            }
+        };
+
+        static constexpr size_t SAMPLE_OFFSET = ( sizeof(Header) + SAMPLE_ALIGNMENT - 1 ) / SAMPLE_ALIGNMENT * SAMPLE_ALIGNMENT;
+
+        static juce::File getFile(const juce::File& directory, const SpectrumKey& key)
+        {
+            return directory.getChildFile(juce::String::toHexString((juce::int64)key.hash).paddedLeft('0', 16) + FILE_EXTENSION);
+        }
+
+        /// @brief Maps the file of the spectrum, if there is a valid one. A file this build can never load, because of its size or header, is deleted.
+        /// A loaded file counts as used, so pruning keeps it longer
+        /// @param directory The folder of the cache files. Nothing is loaded if it is the default juce::File
+        /// @return The mapped set, or nullptr
+        static WavetableSet::Ptr load(const juce::File& directory, const SpectrumKey& key)
+        {
+            if( directory == juce::File() )
+                return nullptr;
+
+            auto file = getFile(directory, key);
+            if( !file.existsAsFile() )
+                return nullptr;
+
+            auto mapping = std::make_unique<juce::MemoryMappedFile>(file, juce::MemoryMappedFile::readOnly);
+            const auto* data = static_cast<const char*>(mapping->getData());
+            if( data == nullptr )
+                return nullptr;
+
+            auto header = std::make_unique<Header>();       //Too big for the worker's stack to be comfortable
+            const bool sizeMatches = mapping->getSize() == SAMPLE_OFFSET + WavetableSet::getNumSamplePoints() * sizeof(float);
+            if( sizeMatches )
+                std::memcpy(header.get(), data, sizeof(Header));
+
+            if( !sizeMatches || !header->hasCurrentLayout() )
+            {   //The mapping has to be closed first, some systems can't delete a mapped file
+                mapping.reset();
+                file.deleteFile();
+                return nullptr;
+            }
+
+            if( !header->holds(key) )
+            {   //Another spectrum with the same hash, its file is still good
+                return nullptr;
+            }
+
+            file.setLastModificationTime(juce::Time::getCurrentTime());
+
+            std::array<float, HARMONIC_N> gains, phases;
+            key.getPartials(gains, phases);
+
+            const auto* samples = reinterpret_cast<const float*>(data + SAMPLE_OFFSET);
+            return WavetableSet::createMapped(std::move(mapping), samples, header->gainToNormalize, PartialSpectrum::fromPartials(gains, phases, header->gainToNormalize));
+        }
+
+        /// @brief Writes the set into the file of its spectrum, unless it is silent or already stored. The file is replaced atomically, so a reader never maps a half written one
+        /// @return True if the file holds the set afterwards
+        static bool save(const juce::File& directory, const SpectrumKey& key, const WavetableSet& set)
+        {
+            if( set.isSilent() || directory == juce::File() )
+                return false;
+
+            auto file = getFile(directory, key);
+            if( file.existsAsFile() )
+                return true;
+
+            if( !directory.createDirectory() )
+                return false;
+
+            auto header = std::make_unique<Header>();
+            header->hash = key.hash;
+            header->keyValues = key.values;
+            header->gainToNormalize = set.getGainToNormalize();
+
+            juce::TemporaryFile temporary(file);
+            {
+                juce::FileOutputStream stream(temporary.getFile());
+                if( !stream.openedOk() )
+                    return false;
+
+                std::array<char, SAMPLE_OFFSET - sizeof(Header)> padding {};
+                stream.write(header.get(), sizeof(Header));
+                stream.write(padding.data(), padding.size());
+                stream.write(set.getSamples(), WavetableSet::getNumSamplePoints() * sizeof(float));
+
+                stream.flush();
+                if( stream.getStatus().failed() )
+                    return false;
+            }
+
+            if( !temporary.overwriteTargetFileWithTemporary() )
+                return false;
+
+            prune(directory, WAVETABLE_DISK_BUDGET, file);
+            return true;
+        }
+
+        /// @brief Deletes the least recently used files of the folder until the rest fit into the budget. Files that other instances have mapped may fail to delete, they are tried again at the next prune
+        /// @param keep A file that stays even if it doesn't fit, like the one just written
+        static void prune(const juce::File& directory, juce::int64 budgetBytes, const juce::File& keep = {})
+        {
+            auto files = directory.findChildFiles(juce::File::findFiles, false, juce::String("*") + FILE_EXTENSION);
+
+            //Loading a file touches it, so the newest modification time is the most recent use
+            std::sort(files.begin(), files.end(), [] (const juce::File& a, const juce::File& b)
+            {
+                return a.getLastModificationTime() > b.getLastModificationTime();
+            });
+
+            juce::int64 usedBytes = keep.existsAsFile() ? keep.getSize() : 0;
+            for(const auto& file : files)
+            {
+                if( file == keep )
+                    continue;
+
+                const auto size = file.getSize();
+                if( usedBytes + size > budgetBytes && file.deleteFile() )
+                    continue;
+
+                usedBytes += size;
+            }
+        }
+    };
+}
@@ -0,0 +1,215 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "Wavetable.h"
+
+namespace Processor::Synthesizer
+{
+    constexpr int MAX_DELTA_PARTIALS = 4;           //If more partials change at once, regenerating the levels with the FFT is cheaper
+    constexpr int DELTA_RESYNC_INTERVAL = 256;      //The number of incremental updates after which the levels are regenerated, to clear accumulated rounding errors
+    constexpr int PEAK_PROBE_POINTS = 16 * HARMONIC_N;  //The resolution the peak of the waveform is measured at. 16 points per cycle of the highest harmonic keep the error below 2%
+    constexpr uint32_t ALL_LEVELS = (1u << LOOKUP_SIZE) - 1;
+
+    /// @brief Builds the mipmap levels of the oscillator's wavetable straight from the partials' spectrum with inverse FFTs. Each level only contains the harmonics that it is allowed to hold.
+    /// Only the levels that are asked for are built, the others are left out of date until they are needed
+    class WavetableGenerator
+    {
+    public:
+        WavetableGenerator()
+        {
+            for(int i = 0; i < LOOKUP_SIZE; i++)
+            {   //Neighbouring levels often have the same size, they share one transform
+                auto& transform = transforms[(size_t)getLevelOrder(i)];
+                if(transform == nullptr)
+                    transform = std::make_unique<juce::dsp::FFT>(getLevelOrder(i));
+
+                levels.emplace_back(getLevelSize(i), 0.f);
+            }
+
+            peakTransform = std::make_unique<juce::dsp::FFT>(juce::roundToInt(std::log2(PEAK_PROBE_POINTS)));
+            spectrum.resize(2 * juce::jmax(LOOKUP_POINTS, PEAK_PROBE_POINTS));
+
+            sineTable.resize(LOOKUP_POINTS);
+            for(int i = 0; i < LOOKUP_POINTS; i++)
+            {
+                sineTable[i] = (float)std::sin(juce::MathConstants<double>::twoPi * i / LOOKUP_POINTS);
+            }
+
+            builtGains.fill(0.f);
+            builtPhases.fill(0.f);
+        }
+
+        /// @brief Brings the levels up to date with the given spectrum. If only a few partials differ from the ones the levels were built from, just the difference of those sinusoids is added to the up to date levels that hold them.
+        /// Otherwise every level goes out of date. The wanted levels that are out of date are then regenerated
+        /// @param gains The linear gains of the partials
+        /// @param phases The phases of the partials, as a proportion of 2 * pi radians
+        /// @param wantedLevels A mask of the levels that have to be up to date afterwards, bit i stands for level i
+        /// @param shouldAbort Checked before every regenerated level. The levels that were finished stay up to date, the incremental updates are cheap and always finish
+        /// @return The gain that peak-normalises the waveform, or 0 if the waveform is silent. Nothing if it was aborted
+        std::optional<float> update(const std::array<float, HARMONIC_N>& gains, const std::array<float, HARMONIC_N>& phases, uint32_t wantedLevels, const std::function<bool()>& shouldAbort = {})
+        {
+            std::array<int, MAX_DELTA_PARTIALS> changedPartials;
+            int changedCount = 0;
+            for(int i = 0; i < HARMONIC_N; i++)
+            {
+                if(gains[i] != builtGains[i] || phases[i] != builtPhases[i])
+                {
+                    if(changedCount < MAX_DELTA_PARTIALS)
+                    {
+                        changedPartials[changedCount] = i;
+                    }
+                    changedCount++;
+                }
+            }
+
+            if(changedCount > MAX_DELTA_PARTIALS || deltaUpdates >= DELTA_RESYNC_INTERVAL)
+            {
+                builtGains = gains;
+                builtPhases = phases;
+                validLevels = 0;
+                deltaUpdates = 0;
+                gainToNormalize.reset();
+            }
+            else if(changedCount > 0)
+            {
+                for(int i = 0; i < changedCount; i++)
+                {
+                    int partial = changedPartials[i];
+                    addPartialDelta(partial, gains[partial], phases[partial]);
+                }
+
+                deltaUpdates++;
+                gainToNormalize.reset();
+            }
+
+            for(int i = 0; i < LOOKUP_SIZE; i++)
+            {
+                if((wantedLevels & ~validLevels & (1u << i)) == 0)
+                    continue;
+
+                if(shouldAbort && shouldAbort())
+                    return std::nullopt;
+
+                generateLevel(i);
+                validLevels |= 1u << i;
+            }
+
+            if(!gainToNormalize)
+            {
+                gainToNormalize = measureGainToNormalize();
+            }
+            return gainToNormalize;
+        }
+
+        /// @return A mask of the levels that hold the spectrum of the last update
+        uint32_t getValidLevels() const { return validLevels; }
+
+        const float* getLevel(int level) const { return levels[level].data(); }
+
+        /// @return The base 2 logarithm of the level's size
+        static int getLevelOrder(int level) { return juce::findHighestSetBit((uint32_t)getLevelSize(level)); }
+
+        /// @return The largest power of two that doesn't exceed POINTS_PER_HARMONIC points for each of the level's harmonics.
+        /// The octave levels get the full count and the two steps below them fall to the next size down, so every third-octave level keeps more than 32 points per harmonic
+        /// instead of all three paying for the octave's size. A full set is 65110 points (254 KB) this way, rounding up made it 97494 (380 KB)
+        static int getLevelSize(int level) { return 1 << juce::findHighestSetBit((uint32_t)( MIPMAP_HARMONICS[level] * POINTS_PER_HARMONIC )); }
+        static int getLevelHarmonics(int level) { return MIPMAP_HARMONICS[level]; }
+
+    private:
+        std::array<std::unique_ptr<juce::dsp::FFT>, 32> transforms;    //Indexed by the order of the transform
+        std::unique_ptr<juce::dsp::FFT> peakTransform;
+        std::vector<std::vector<float>> levels;
+        std::vector<float> spectrum;
+
+        std::vector<float> sineTable;                       //One cycle of a sine at the resolution of the first level, used for the incremental updates
+        std::array<float, HARMONIC_N> builtGains;           //The spectrum the valid levels hold
+        std::array<float, HARMONIC_N> builtPhases;
+        uint32_t validLevels = 0;                           //Bit i is set if level i holds the built spectrum
+        std::optional<float> gainToNormalize;               //Measured from the built spectrum, reset whenever it changes
+        int deltaUpdates = 0;
+
+        /// @brief Fills one mipmap level with an inverse real FFT of the built partials that fit into it
+        void generateLevel(int level)
+        {
+            const int size = getLevelSize(level);
+            const int harmonics = juce::jmin(getLevelHarmonics(level), size / 2 - 1);
+
+            inverseTransform(*transforms[(size_t)getLevelOrder(level)], size, harmonics);
+            std::copy(spectrum.begin(), spectrum.begin() + size, levels[level].begin());
+        }
+
+        /// @brief Renders the given number of built partials into the first size points of the spectrum buffer
+        void inverseTransform(const juce::dsp::FFT& transform, int size, int harmonics)
+        {
+            std::fill(spectrum.begin(), spectrum.begin() + 2 * size, 0.f);
+
+            //A partial of gain g and phase p is g * sin(k * x + p). For a 1/N scaled inverse transform its bin holds N/2 * g * (sin(p) - i * cos(p))
+            for(int i = 0; i < harmonics; i++)
+            {
+                if(builtGains[i] != 0.f)
+                {
+                    float phase = builtPhases[i] * juce::MathConstants<float>::twoPi;
+                    float magnitude = 0.5f * (float)size * builtGains[i];
+
+                    spectrum[2 * (i + 1)] = magnitude * std::sin(phase);
+                    spectrum[2 * (i + 1) + 1] = -magnitude * std::cos(phase);
+                }
+            }
+
+            transform.performRealOnlyInverseTransform(spectrum.data());
+        }
+
+        /// @brief Finds the gain that peak-normalises the waveform. Measured on a separate rendering of every harmonic, so it doesn't depend on which levels are built
+        /// @return The normalising gain, or 0 if the waveform is silent
+        float measureGainToNormalize()
+        {
+            inverseTransform(*peakTransform, PEAK_PROBE_POINTS, HARMONIC_N);
+
+            auto range = juce::FloatVectorOperations::findMinAndMax(spectrum.data(), PEAK_PROBE_POINTS);
+            float peakAmplitude = juce::jmax(std::abs(range.getStart()), std::abs(range.getEnd()));
+
+            return peakAmplitude > 0.f ? 1.f / peakAmplitude : 0.f;
+        }
+
+        /// @brief Replaces one partial in every valid level that holds it, by adding the difference of the new and the old sinusoid. The other levels are regenerated when they are wanted.
+        /// g * sin(k * x + p) is split into g * cos(p) * sin(k * x) + g * sin(p) * cos(k * x), so the levels only need lookups into the sine table
+        void addPartialDelta(int partial, float gain, float phase)
+        {
+            float oldPhase = builtPhases[partial] * juce::MathConstants<float>::twoPi;
+            float newPhase = phase * juce::MathConstants<float>::twoPi;
+
+            float sineGain = gain * std::cos(newPhase) - builtGains[partial] * std::cos(oldPhase);
+            float cosineGain = gain * std::sin(newPhase) - builtGains[partial] * std::sin(oldPhase);
+
+            const int mask = LOOKUP_POINTS - 1;
+            const int quarterCycle = LOOKUP_POINTS / 4;
+
+            for(int level = 0; level < LOOKUP_SIZE; level++)
+            {
+                const int size = getLevelSize(level);
+                if(partial >= juce::jmin(getLevelHarmonics(level), size / 2 - 1))
+                {   //The levels hold fewer and fewer harmonics, none of the remaining ones contain this partial
+                    break;
+                }
+
+                if((validLevels & (1u << level)) == 0)
+                    continue;
+
+                const int step = (partial + 1) * (LOOKUP_POINTS / size);
+                auto* data = levels[level].data();
+
+                int index = 0;
+                for(int i = 0; i < size; i++)
+                {
+                    data[i] += sineGain * sineTable[index] + cosineGain * sineTable[(index + quarterCycle) & mask];
+                    index = (index + step) & mask;
+                }
+            }
+
+            builtGains[partial] = gain;
+            builtPhases[partial] = phase;
+        }
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(WavetableGenerator)
+    };
+}
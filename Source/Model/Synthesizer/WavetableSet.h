@@ -0,0 +1,217 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "Wavetable.h"
+#include "WavetableGenerator.h"
+#include "SineBankKernel.h"
+
+namespace Processor::Synthesizer
+{
+    /// @brief Every mipmap level of one waveform and its partial spectrum. The set and the samples of all of its levels are one allocation, so a set is published, read and freed as a whole.
+    /// The levels are built on demand: a level starts empty, is claimed by the worker that builds it and never changes once it is ready. Sets loaded from the disk cache are complete and read their samples from the mapped file instead
+    class WavetableSet
+    {
+    public:
+        enum class LevelState : uint8_t
+        {
+            empty,
+            building,
+            ready
+        };
+
+        struct Deleter
+        {
+            void operator()(WavetableSet* set) const
+            {
+                set->~WavetableSet();
+                ::operator delete(set, std::align_val_t(alignof(WavetableSet)));
+            }
+        };
+
+        using Ptr = std::unique_ptr<WavetableSet, Deleter>;
+        using SharedPtr = std::shared_ptr<WavetableSet>;    //Sets are shared by the instances that play the same waveform, which may all fill in its levels
+
+        /// @brief Creates a set with room for every level, all of them empty
+        /// @param gainToNormalize The gain the levels are multiplied with when they are filled. The set is silent if it is 0
+        static Ptr create(float gainToNormalize, const PartialSpectrum& spectrum)
+        {
+            if( gainToNormalize <= 0.f )
+                return createSilent();
+
+            Ptr set = allocate(getNumSamplePoints());
+            set->gain = gainToNormalize;
+            set->pointLevelsAt(reinterpret_cast<float*>(set.get() + 1));
+            set->spectrum = spectrum;
+            return set;
+        }
+
+        /// @brief Creates a complete set whose levels are read straight from a memory mapped file, which the set keeps open
+        /// @param samples The samples of every level in the file, laid out like getSamples
+        /// @param gainToNormalize The gain the stored levels were multiplied with
+        static Ptr createMapped(std::unique_ptr<juce::MemoryMappedFile> file, const float* samples, float gainToNormalize, const PartialSpectrum& spectrum)
+        {
+            Ptr set = allocate(0);
+            set->mappedFile = std::move(file);
+            set->gain = gainToNormalize;
+            set->pointLevelsAt(samples);
+            set->spectrum = spectrum;
+            set->setAllReady();
+            return set;
+        }
+
+        /// @brief Creates a complete set whose levels are all silent and whose spectrum is empty
+        static Ptr createSilent()
+        {
+            Ptr set = allocate(0);
+            set->setAllReady();
+            return set;
+        }
+
+        /// @brief Finds the level to render with on the audio thread, and asks for the wanted level to be built if it isn't yet
+        /// @return The wanted level if it is ready, otherwise the closest ready one with fewer harmonics, so the fallback never aliases. Silence if none is ready
+        const Wavetable& findLevel(int level) const noexcept
+        {
+            const uint32_t bit = 1u << level;
+            if( (demandedLevels.load(std::memory_order_relaxed) & bit) == 0 )
+                demandedLevels.fetch_or(bit, std::memory_order_relaxed);
+
+            for(int i = level; i < LOOKUP_SIZE; i++)
+            {
+                if( levelStates[i].load(std::memory_order_acquire) == LevelState::ready )
+                    return levels[i];
+            }
+            return silentLevel;
+        }
+
+        /// @return A mask of the levels that voices asked for, bit i stands for level i
+        uint32_t getDemandedLevels() const noexcept { return demandedLevels.load(std::memory_order_relaxed); }
+
+        /// @brief Asks for levels, for example the ones the voices used with the previous set
+        void demandLevels(uint32_t levelMask) noexcept { demandedLevels.fetch_or(levelMask, std::memory_order_relaxed); }
+
+        /// @return A mask of the levels that are ready
+        uint32_t getReadyLevels() const noexcept
+        {
+            uint32_t mask = 0;
+            for(int i = 0; i < LOOKUP_SIZE; i++)
+            {
+                if( levelStates[i].load(std::memory_order_acquire) == LevelState::ready )
+                    mask |= 1u << i;
+            }
+            return mask;
+        }
+
+        /// @return A mask of the levels that were asked for but aren't ready
+        uint32_t getMissingLevels() const noexcept { return getDemandedLevels() & ~getReadyLevels(); }
+
+        bool isComplete() const noexcept { return getReadyLevels() == ALL_LEVELS; }
+
+        /// @brief Claims the empty levels of the mask for the calling worker. Levels that are ready or being built by another instance's worker are left out
+        /// @return A mask of the claimed levels, which the caller has to fill or release
+        uint32_t claimLevels(uint32_t levelMask)
+        {
+            uint32_t claimed = 0;
+            for(int i = 0; i < LOOKUP_SIZE; i++)
+            {
+                auto expected = LevelState::empty;
+                if( (levelMask & (1u << i)) != 0 && levelStates[i].compare_exchange_strong(expected, LevelState::building) )
+                    claimed |= 1u << i;
+            }
+            return claimed;
+        }
+
+        /// @brief Gives claimed levels back without filling them, so they can be claimed again
+        void releaseLevels(uint32_t levelMask)
+        {
+            for(int i = 0; i < LOOKUP_SIZE; i++)
+            {
+                if( (levelMask & (1u << i)) != 0 )
+                    levelStates[i].store(LevelState::empty, std::memory_order_release);
+            }
+        }
+
+        /// @brief Copies a claimed level in with the set's normalising gain and the closing point, then makes it ready
+        /// @param source The unnormalised level, as built by the WavetableGenerator
+        void fillLevel(int level, const float* source)
+        {
+            jassert(levelStates[level].load() == LevelState::building && numHeapPoints > 0);
+
+            float* destination = reinterpret_cast<float*>(this + 1) + getLevelOffset(level);
+            const int size = WavetableGenerator::getLevelSize(level);
+            juce::FloatVectorOperations::copyWithMultiply(destination, source, gain, size);
+            destination[size] = destination[0];
+
+            levelStates[level].store(LevelState::ready, std::memory_order_release);
+        }
+
+        /// @brief The nonzero partials the levels were built from
+        const PartialSpectrum& getSpectrum() const { return spectrum; }
+
+        /// @return The gain the levels were multiplied with, 0 for a silent set
+        float getGainToNormalize() const { return gain; }
+
+        bool isSilent() const { return samples == nullptr; }
+
+        /// @brief The samples of every level one after the other, each followed by its closing point. nullptr if the set is silent. Only complete once every level is ready
+        const float* getSamples() const { return samples; }
+
+        /// @return The number of samples getSamples points to in a set that isn't silent
+        static size_t getNumSamplePoints() { return getLevelOffset(LOOKUP_SIZE); }
+
+        /// @return The size of the set's allocation on the heap. The samples of a mapped set are in the file's pages instead
+        size_t getSizeInBytes() const { return sizeof(WavetableSet) + numHeapPoints * sizeof(float); }
+
+    private:
+        static inline const Wavetable silentLevel {};
+
+        std::array<Wavetable, LOOKUP_SIZE> levels;
+        std::array<std::atomic<LevelState>, LOOKUP_SIZE> levelStates {};
+        mutable std::atomic<uint32_t> demandedLevels { 0 };     //Set by the audio threads of every instance that plays the set
+        PartialSpectrum spectrum;
+        float gain = 0.f;
+        const float* samples = nullptr;
+        size_t numHeapPoints = 0;                           //The number of samples allocated right behind the set
+        std::unique_ptr<juce::MemoryMappedFile> mappedFile;
+
+        WavetableSet() = default;
+
+        /// @brief Allocates a set with room for the given number of samples right behind it
+        static Ptr allocate(size_t numSamplePoints)
+        {
+            void* memory = ::operator new(sizeof(WavetableSet) + numSamplePoints * sizeof(float), std::align_val_t(alignof(WavetableSet)));
+            Ptr set(new (memory) WavetableSet());
+            set->numHeapPoints = numSamplePoints;
+            return set;
+        }
+
+        /// @return The position of the level's first sample in getSamples
+        static size_t getLevelOffset(int level)
+        {
+            size_t offset = 0;
+            for(int i = 0; i < level; i++)
+            {
+                offset += (size_t)WavetableGenerator::getLevelSize(i) + 1;
+            }
+            return offset;
+        }
+
+        void pointLevelsAt(const float* levelSamples)
+        {
+            samples = levelSamples;
+            for(int i = 0; i < LOOKUP_SIZE; i++)
+            {
+                levels[i] = Wavetable(levelSamples + getLevelOffset(i), WavetableGenerator::getLevelSize(i));
+            }
+        }
+
+        void setAllReady()
+        {
+            for(auto& state : levelStates)
+            {
+                state.store(LevelState::ready, std::memory_order_release);
+            }
+        }
+
+        JUCE_DECLARE_NON_COPYABLE(WavetableSet)
+    };
+}
@@ -23,12 +23,14 @@ namespace Editor
         keyboardComponent->setOctaveForMiddleC(4);
         keyboardComponent->setScrollButtonsVisible(false);
         addAndMakeVisible(*keyboardComponent);
+        audioProcessor.keyboardBridge.setDisplayActive(true);
 
         setLookAndFeel(&lnf);    
     }
 
     VST_SynthAudioProcessorEditor::~VST_SynthAudioProcessorEditor()
     {
+        audioProcessor.keyboardBridge.setDisplayActive(false);
         setLookAndFeel(nullptr);
     }
 
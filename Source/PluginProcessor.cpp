@@ -8,6 +8,7 @@
 
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
+#include "Utils/RealtimeSanitizer.h"
 
 VST_SynthAudioProcessor::VST_SynthAudioProcessor()
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -72,6 +73,7 @@ void VST_SynthAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBl
 {
     additiveSynth.prepareToPlay(sampleRate, samplesPerBlock);
     fxChain.prepareToPlay(sampleRate, samplesPerBlock);
+    keyboardBridge.prepareToPlay();
 
     for(int i = 0; i < 2; i++)
     {
@@ -105,22 +107,28 @@ bool VST_SynthAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts
 
 void VST_SynthAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
+    Utils::ScopedRealtimeCheck realtimeCheck;
     juce::ScopedNoDenormals noDenormals;
+    parameterSnapshotBuilder.build();
+
     auto totalNumInputChannels  = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
     auto numSamples = buffer.getNumSamples();
 
-    keyboardState.processNextMidiBuffer(midiMessages, 0, numSamples, true);
+    auto& blockMessages = keyboardBridge.processNextMidiBuffer(midiMessages);
 
     for(int i = totalNumInputChannels; i < totalNumOutputChannels; i++)
         buffer.clear (i, 0, numSamples);
 
-    additiveSynth.processBlock(buffer, midiMessages);
+    additiveSynth.processBlock(buffer, blockMessages);
+
+    //An idle synth left the buffer silent, the meters only have to fall without scanning it
+    const bool synthIdle = additiveSynth.isIdle();
 
     for(int i = 0; i < 2; i++)
     {
         synthRMS[i].skip(numSamples);
-        auto value = juce::Decibels::gainToDecibels(buffer.getRMSLevel(i, 0, numSamples));
+        auto value = synthIdle ? juce::Decibels::gainToDecibels(0.f) : juce::Decibels::gainToDecibels(buffer.getRMSLevel(i, 0, numSamples));
         if(value > synthRMS[i].getCurrentValue())
         {
             synthRMS[i].setCurrentAndTargetValue(value);
@@ -132,7 +140,7 @@ void VST_SynthAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, ju
         atomicSynthRMS[i].set(synthRMS[i].getCurrentValue());
     }
 
-    fxChain.processBlock(buffer, midiMessages);
+    fxChain.processBlock(buffer, blockMessages);
     
     midiMessages.clear();
 }
@@ -148,6 +156,9 @@ void VST_SynthAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
 {
     juce::MemoryOutputStream outputStream(destData, true);
     apvts.state.writeToStream(outputStream);
+
+    //Saving the state is a good moment to keep the waveform for the next session, unlike every spectrum passed while editing
+    additiveSynth.getOscParameters().requestWavetableSave();
 }
 
 void VST_SynthAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
@@ -155,6 +166,17 @@ void VST_SynthAudioProcessor::setStateInformation (const void* data, int sizeInB
     juce::ValueTree tree = juce::ValueTree::readFromData(data, sizeInBytes);
     if (tree.isValid())
     {
+        for(auto* parameter : getParameters())
+        {   //Sessions saved before a parameter existed would otherwise leave it at whatever value the previous state set
+            auto* ranged = dynamic_cast<juce::RangedAudioParameter*>(parameter);
+            if(ranged != nullptr && !tree.getChildWithProperty("id", ranged->paramID).isValid())
+            {
+                juce::ValueTree child("PARAM");
+                child.setProperty("id", ranged->paramID, nullptr);
+                child.setProperty("value", ranged->convertFrom0to1(ranged->getDefaultValue()), nullptr);
+                tree.appendChild(child, nullptr);
+            }
+        }
         apvts.replaceState(tree);
     }
 }
@@ -11,6 +11,9 @@
 #include <JuceHeader.h>
 #include "Model/Synthesizer/AdditiveSynthesizer.h"
 #include "Model/Effects/EffectProcessorChain.h"
+#include "Model/ParameterRegistry.h"
+#include "Model/ParameterSnapshot.h"
+#include "Utils/KeyboardStateBridge.h"
 
 class VST_SynthAudioProcessor : public juce::AudioProcessor
 #if JucePlugin_Enable_ARA
@@ -57,13 +60,19 @@ public:
     juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
     juce::AudioProcessorValueTreeState apvts { *this, nullptr, juce::Identifier(JucePlugin_Name), createParameterLayout() };
 
-    Processor::Synthesizer::AdditiveSynthesizer additiveSynth = Processor::Synthesizer::AdditiveSynthesizer(apvts);
-    Processor::Effects::EffectsChain::EffectProcessorChain fxChain = Processor::Effects::EffectsChain::EffectProcessorChain(apvts);
+    Processor::ParameterRegistry parameterRegistry { apvts };  //The current value of every parameter, by dense index
+
+    Processor::ParameterSnapshot parameterSnapshot;     //Rebuilt at the start of every processBlock, everything that renders reads its parameters from here
+    Processor::ParameterSnapshotBuilder parameterSnapshotBuilder { parameterRegistry, parameterSnapshot };
+
+    Processor::Synthesizer::AdditiveSynthesizer additiveSynth = Processor::Synthesizer::AdditiveSynthesizer(apvts, parameterRegistry, parameterSnapshot.synth);
+    Processor::Effects::EffectsChain::EffectProcessorChain fxChain = Processor::Effects::EffectsChain::EffectProcessorChain(apvts, parameterRegistry, parameterSnapshot);
 
     juce::LinearSmoothedValue<float> synthRMS[2];
     juce::Atomic<float> atomicSynthRMS[2];
 
-    juce::MidiKeyboardState keyboardState;
+    juce::MidiKeyboardState keyboardState;            //Only used on the message thread, by the on-screen keyboard
+    Utils::KeyboardStateBridge keyboardBridge { keyboardState };
 
 private:
     //==============================================================================
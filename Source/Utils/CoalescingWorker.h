@@ -0,0 +1,123 @@
+#pragma once
+#include <JuceHeader.h>
+
+namespace Utils
+{
+    /// @brief A long-lived thread that runs one job whenever it is asked to. The thread sleeps on an atomic between jobs, so asking never takes a lock and an idle worker never wakes up on its own.
+    /// Requests that arrive while the job is running are merged into one rerun, and the running job can poll isStale to give up early once its result is already outdated
+    class CoalescingWorker : private juce::Thread
+    {
+    public:
+        /// @param job The function to run. It should check isStale at its expensive steps and return early if it is set
+        CoalescingWorker(const juce::String& threadName, std::function<void()> job) :
+            juce::Thread(threadName),
+            job(std::move(job))
+        {
+            startThread();
+        }
+
+        ~CoalescingWorker() override
+        {
+            signalThreadShouldExit();
+            wakeUp();
+            stopThread(1000);
+        }
+
+        /// @brief Asks for the job to run again, with everything that changed up to now, and makes the running job stale.
+        /// Lock free and never blocks, so the audio thread and parameter callbacks, which can run on it, can call it
+        void request()
+        {
+            juce::int64 noPendingRequest = 0;
+            firstRequestTicks.compare_exchange_strong(noPendingRequest, juce::Time::getHighResolutionTicks());
+
+            requestedGeneration.fetch_add(1, std::memory_order_release);
+            wakeUp();
+        }
+
+        /// @brief Asks for one more run after the running job has finished, without making it stale. For work that adds to the running job's instead of replacing its input.
+        /// Lock free and never blocks, like request
+        void requestFollowUp()
+        {
+            followUpRequest.store(true, std::memory_order_release);
+            wakeUp();
+        }
+
+        /// @brief Tells the running job that a newer request arrived or that the worker is stopping, so its result would be thrown away. Only call it from the job
+        bool isStale() const
+        {
+            return requestedGeneration.load(std::memory_order_acquire) != runningGeneration || threadShouldExit();
+        }
+
+        /// @return The time between the first request of the last burst and the end of the job that served it, in milliseconds
+        double getLastLatencyMs() const { return lastLatencyMs.load(std::memory_order_relaxed); }
+
+        /// @return The longest latency measured since the worker started, in milliseconds
+        double getMaxLatencyMs() const { return maxLatencyMs.load(std::memory_order_relaxed); }
+
+    private:
+        std::function<void()> job;
+        std::atomic<uint32_t> wakeUps { 0 };                //Counts the calls of wakeUp, the idle worker waits for it to change
+        std::atomic<bool> followUpRequest { false };
+
+        std::atomic<uint32_t> requestedGeneration { 0 };
+        uint32_t runningGeneration = 0;                     //The request the running job serves, only touched by the worker
+        uint32_t completedGeneration = 0;
+
+        std::atomic<juce::int64> firstRequestTicks { 0 };   //When the oldest unserved request arrived, 0 if every request is served
+        std::atomic<double> lastLatencyMs { 0.0 };
+        std::atomic<double> maxLatencyMs { 0.0 };
+
+        /// @brief Changes the counter the idle worker waits on. On the usual platforms notifying an atomic is a futex or address wake, which takes no lock
+        void wakeUp()
+        {
+            wakeUps.fetch_add(1, std::memory_order_release);
+            wakeUps.notify_one();
+        }
+
+        void run() override
+        {
+            while( !threadShouldExit() )
+            {
+                //Read before looking for requests, so one that arrives in between changes it and the wait returns at once
+                const auto seenWakeUps = wakeUps.load(std::memory_order_acquire);
+
+                while( !threadShouldExit() && hasPendingRequest() )
+                {
+                    runningGeneration = requestedGeneration.load(std::memory_order_acquire);
+                    job();
+
+                    if( !isStale() )
+                    {
+                        completedGeneration = runningGeneration;
+                        measureLatency();
+                    }
+                }
+
+                if( !threadShouldExit() )
+                    wakeUps.wait(seenWakeUps, std::memory_order_acquire);
+            }
+        }
+
+        /// @brief Turns a follow-up request into a normal one. Only called between jobs, so it never makes a running job stale
+        bool hasPendingRequest()
+        {
+            if( followUpRequest.exchange(false, std::memory_order_acquire) )
+                requestedGeneration.fetch_add(1, std::memory_order_release);
+
+            return requestedGeneration.load(std::memory_order_acquire) != completedGeneration;
+        }
+
+        void measureLatency()
+        {
+            const auto requestTicks = firstRequestTicks.exchange(0);
+            if( requestTicks == 0 )
+                return;
+
+            const double latency = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - requestTicks) * 1000.0;
+            lastLatencyMs.store(latency, std::memory_order_relaxed);
+            maxLatencyMs.store(juce::jmax(latency, maxLatencyMs.load(std::memory_order_relaxed)), std::memory_order_relaxed);
+        }
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CoalescingWorker)
+    };
+}
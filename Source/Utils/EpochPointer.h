@@ -0,0 +1,101 @@
+#pragma once
+#include <JuceHeader.h>
+
+namespace Utils
+{
+    /// @brief Publishes immutable objects from one writer thread to one reader thread, RCU style.
+    /// The reader brackets its reads with a ReadScope, which only stores its epoch and loads the pointer, so it never locks, allocates or frees.
+    /// Replaced objects are retired with the epoch they were replaced in, and the writer drops them once the reader has left every scope that could still see them
+    /// @tparam Ptr The owning pointer the writer hands over, a unique_ptr or a shared_ptr if the objects are shared with other owners
+    template <typename T, typename Ptr = std::unique_ptr<T>>
+    class EpochPointer
+    {
+    public:
+        explicit EpochPointer(Ptr initial) :
+            current(initial.get()),
+            currentOwner(std::move(initial))
+        {
+            jassert(current.load() != nullptr);
+        }
+
+        ~EpochPointer()
+        {
+            jassert(readerEpoch.load() == idle);    //The reader must not outlive the pointer
+        }
+
+        /// @brief Keeps the object that was current when the scope was entered alive until the scope is left. Only one scope may be open at a time
+        class ReadScope
+        {
+        public:
+            explicit ReadScope(const EpochPointer& owner) : owner(owner)
+            {
+                jassert(owner.readerEpoch.load(std::memory_order_relaxed) == idle);
+
+                //The epoch has to be visible to the writer before the pointer is read, so both are sequentially consistent
+                owner.readerEpoch.store(owner.epoch.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+                object = owner.current.load(std::memory_order_seq_cst);
+            }
+
+            ~ReadScope()
+            {
+                owner.readerEpoch.store(idle, std::memory_order_release);
+            }
+
+            const T* get() const { return object; }
+            const T& operator*() const { return *object; }
+            const T* operator->() const { return object; }
+
+        private:
+            const EpochPointer& owner;
+            const T* object = nullptr;
+
+            JUCE_DECLARE_NON_COPYABLE(ReadScope)
+        };
+
+        /// @brief Enters a read-side critical section on the reader thread
+        ReadScope read() const { return ReadScope(*this); }
+
+        /// @brief Makes the object current and retires the previous one. Writer thread only
+        void publish(Ptr replacement)
+        {
+            jassert(replacement != nullptr);
+
+            current.store(replacement.get(), std::memory_order_seq_cst);
+            const auto retiredIn = epoch.fetch_add(1, std::memory_order_seq_cst) + 1;
+            retired.push_back({ std::exchange(currentOwner, std::move(replacement)), retiredIn });
+
+            reclaim();
+        }
+
+        /// @brief Drops the retired objects the reader can no longer see. Writer thread only
+        void reclaim()
+        {
+            //An idle reader has the largest epoch, so it never holds anything back
+            const auto activeEpoch = readerEpoch.load(std::memory_order_seq_cst);
+            std::erase_if(retired, [activeEpoch](const auto& entry) { return activeEpoch >= entry.retiredIn; });
+        }
+
+        /// @return The current object. Only safe on the writer thread, which is the only one that frees
+        const Ptr& getLatest() const { return currentOwner; }
+
+        /// @return The number of replaced objects that are still waiting for the reader
+        int getNumRetired() const { return (int)retired.size(); }
+
+    private:
+        static constexpr uint64_t idle = std::numeric_limits<uint64_t>::max();
+
+        struct RetiredObject
+        {
+            Ptr object;
+            uint64_t retiredIn;                             //The first epoch in which the object was no longer current
+        };
+
+        std::atomic<const T*> current;
+        Ptr currentOwner;                                   //Only touched by the writer
+        std::atomic<uint64_t> epoch { 0 };
+        mutable std::atomic<uint64_t> readerEpoch { idle }; //The epoch the reader entered its scope in, or idle
+        std::vector<RetiredObject> retired;                 //Only touched by the writer
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(EpochPointer)
+    };
+}
@@ -0,0 +1,189 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+namespace Utils
+{
+    constexpr int KEYBOARD_QUEUE_SIZE = 256;                //The most note messages that can wait in one direction, more are dropped
+    constexpr int KEYBOARD_DISPLAY_RATE_HZ = 30;            //How often the host's notes are shown on the on-screen keyboard while the editor is open
+    constexpr int MERGED_MIDI_RESERVE_BYTES = 32 * 1024;    //The room of the buffer the host's events and the on-screen keys are merged into, a few thousand short messages
+    constexpr int MIDI_EVENT_OVERHEAD_BYTES = (int)( sizeof(juce::int32) + sizeof(juce::uint16) );    //The timestamp and size a MidiBuffer stores with each message
+
+    /// @brief Passes short MIDI messages from one thread to another without locking or allocating
+    class ShortMidiMessageQueue
+    {
+    public:
+        /// @return False if the queue was full and the message was dropped
+        bool push(const juce::uint8* data, int numBytes) noexcept
+        {
+            jassert(juce::isPositiveAndNotGreaterThan(numBytes, MAX_MESSAGE_BYTES));
+
+            int start1, size1, start2, size2;
+            fifo.prepareToWrite(1, start1, size1, start2, size2);
+            if( size1 + size2 == 0 )
+            {
+                return false;
+            }
+
+            auto& message = messages[(size_t)( size1 > 0 ? start1 : start2 )];
+            message.numBytes = juce::jmin(numBytes, MAX_MESSAGE_BYTES);
+            std::copy(data, data + message.numBytes, message.data.begin());
+
+            fifo.finishedWrite(1);
+            return true;
+        }
+
+        bool push(const juce::MidiMessage& message) noexcept
+        {
+            return push(message.getRawData(), message.getRawDataSize());
+        }
+
+        bool isEmpty() const noexcept { return fifo.getNumReady() == 0; }
+
+        /// @brief Calls the function with the data and size of every waiting message, oldest first
+        template <typename Function>
+        void popAll(Function&& function)
+        {
+            int start1, size1, start2, size2;
+            fifo.prepareToRead(fifo.getNumReady(), start1, size1, start2, size2);
+
+            for(int i = start1; i < start1 + size1; i++)
+                function(messages[(size_t)i].data.data(), messages[(size_t)i].numBytes);
+            for(int i = start2; i < start2 + size2; i++)
+                function(messages[(size_t)i].data.data(), messages[(size_t)i].numBytes);
+
+            fifo.finishedRead(size1 + size2);
+        }
+
+        static constexpr int MAX_MESSAGE_BYTES = 3;
+
+    private:
+        struct Message
+        {
+            std::array<juce::uint8, MAX_MESSAGE_BYTES> data {};
+            int numBytes = 0;
+        };
+
+        juce::AbstractFifo fifo { KEYBOARD_QUEUE_SIZE };
+        std::array<Message, KEYBOARD_QUEUE_SIZE> messages;
+    };
+
+    /// @brief Connects the on-screen keyboard to the audio thread in place of MidiKeyboardState::processNextMidiBuffer.
+    /// The keyboard state takes its lock on every call and the message thread holds it while the keyboard is played, so only the message thread touches the state.
+    /// The keys played on screen reach the audio thread, and the host's notes reach the display, through a lock-free queue each
+    class KeyboardStateBridge : private juce::MidiKeyboardState::Listener,
+                                private juce::Timer
+    {
+    public:
+        explicit KeyboardStateBridge(juce::MidiKeyboardState& state) : state(state)
+        {
+            state.addListener(this);
+        }
+
+        ~KeyboardStateBridge() override
+        {
+            stopTimer();
+            state.removeListener(this);
+        }
+
+        /// @brief Reserves the buffer the keys played on screen are merged into, so merging never allocates on the audio thread. Called from prepareToPlay
+        void prepareToPlay()
+        {
+            mergedMessages.ensureSize(MERGED_MIDI_RESERVE_BYTES);
+        }
+
+        /// @brief Called on the audio thread. Queues the block's notes for the display and returns the events to render.
+        /// That is the host's buffer itself while nothing is played on screen, otherwise the keys played on screen at the start of the block followed by the host's events, in a buffer of the bridge.
+        /// The host's buffer is never added to, as it may not have room. If the host sent more than the reserve can hold next to a full queue, the keys wait for the next block
+        juce::MidiBuffer& processNextMidiBuffer(juce::MidiBuffer& hostMessages)
+        {
+            for(const auto metadata : hostMessages)
+            {
+                const auto message = metadata.getMessage();
+                if( message.isNoteOnOrOff() || message.isAllNotesOff() || message.isAllSoundOff() )
+                {
+                    hostNotes.push(metadata.data, metadata.numBytes);
+                }
+            }
+
+            if( screenNotes.isEmpty() || hostMessages.data.size() > MERGED_MIDI_RESERVE_BYTES - SCREEN_NOTES_RESERVE_BYTES )
+            {
+                return hostMessages;
+            }
+
+            mergedMessages.clear();
+            screenNotes.popAll([this](const juce::uint8* data, int numBytes)
+            {
+                mergedMessages.addEvent(data, numBytes, 0);
+            });
+            mergedMessages.addEvents(hostMessages, 0, -1, 0);
+
+            return mergedMessages;
+        }
+
+        /// @brief Starts or stops showing the host's notes. Called on the message thread by the editor, which owns the on-screen keyboard.
+        /// Stopping releases the keys still held on screen and clears the display
+        void setDisplayActive(bool shouldBeActive)
+        {
+            if( shouldBeActive )
+            {   //Whatever the host played while the editor was closed has no key to light up anymore
+                hostNotes.popAll([](const juce::uint8*, int) {});
+                startTimerHz(KEYBOARD_DISPLAY_RATE_HZ);
+                return;
+            }
+
+            stopTimer();
+            for(int note = 0; note < (int)heldChannels.size(); note++)
+            {
+                if( heldChannels[(size_t)note] > 0 )
+                {
+                    screenNotes.push(juce::MidiMessage::noteOff(heldChannels[(size_t)note], note));
+                    heldChannels[(size_t)note] = 0;
+                }
+            }
+
+            const juce::ScopedValueSetter<bool> showing(showingHostNotes, true);
+            state.allNotesOff(0);
+        }
+
+    private:
+        static constexpr int SCREEN_NOTES_RESERVE_BYTES = KEYBOARD_QUEUE_SIZE * ( MIDI_EVENT_OVERHEAD_BYTES + ShortMidiMessageQueue::MAX_MESSAGE_BYTES );
+
+        juce::MidiKeyboardState& state;
+        ShortMidiMessageQueue screenNotes;                  //Played on screen, read by the audio thread
+        juce::MidiBuffer mergedMessages;                    //The host's events with the keys played on screen, reserved in prepareToPlay. Audio thread only
+        ShortMidiMessageQueue hostNotes;                    //Received from the host, read by the message thread
+
+        std::array<int, 128> heldChannels {};               //The channel of each key held on screen, 0 if it isn't. Message thread only
+        bool showingHostNotes = false;                      //Set while the host's notes are applied to the state, which must not send them back
+
+        void handleNoteOn(juce::MidiKeyboardState*, int midiChannel, int midiNoteNumber, float velocity) override
+        {
+            if( !showingHostNotes )
+            {
+                heldChannels[(size_t)midiNoteNumber] = midiChannel;
+                screenNotes.push(juce::MidiMessage::noteOn(midiChannel, midiNoteNumber, velocity));
+            }
+        }
+
+        void handleNoteOff(juce::MidiKeyboardState*, int midiChannel, int midiNoteNumber, float velocity) override
+        {
+            if( !showingHostNotes )
+            {
+                heldChannels[(size_t)midiNoteNumber] = 0;
+                screenNotes.push(juce::MidiMessage::noteOff(midiChannel, midiNoteNumber, velocity));
+            }
+        }
+
+        void timerCallback() override
+        {
+            const juce::ScopedValueSetter<bool> showing(showingHostNotes, true);
+            hostNotes.popAll([this](const juce::uint8* data, int numBytes)
+            {
+                state.processNextMidiEvent(juce::MidiMessage(data, numBytes));
+            });
+        }
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(KeyboardStateBridge)
+    };
+}
@@ -0,0 +1,272 @@
+#include "RealtimeSanitizer.h"
+
+#if VST_SYNTH_RT_SANITIZER
+
+#include <new>
+#include <cstdio>
+#include <cstdlib>
+
+#if JUCE_LINUX
+ #include <pthread.h>
+ #include <dlfcn.h>
+
+extern "C"
+{
+    //glibc's own entry points, so the hooks can forward to them
+    void* __libc_malloc(size_t);
+    void* __libc_calloc(size_t, size_t);
+    void* __libc_realloc(void*, size_t);
+    void* __libc_memalign(size_t, size_t);
+    void __libc_free(void*);
+}
+#endif
+
+namespace Utils
+{
+    namespace
+    {
+        thread_local bool realtimeThread = false;
+        thread_local bool reporting = false;
+        std::atomic<int> violations { 0 };
+
+        constexpr int MAX_ALLOWED_LOCKS = 64;
+        std::array<std::atomic<const void*>, MAX_ALLOWED_LOCKS> allowedLocks {};   //The mutexes of the allowed locks, nullptr in the free entries
+
+    #if JUCE_LINUX
+        using LockFunction = int (*)(pthread_mutex_t*);
+        std::atomic<LockFunction> nextMutexLock { nullptr };    //glibc has no internal name for the lock it exports, so the next definition after the hook is looked up on first use
+    #endif
+
+        thread_local bool probingLock = false;              //While set, the lock hook records the mutex instead of checking it
+        thread_local const void* probedMutex = nullptr;
+
+        bool isAllowedLock(const void* mutex)
+        {
+            for(auto& allowed : allowedLocks)
+            {
+                if( allowed.load(std::memory_order_relaxed) == mutex )
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        /// @brief Prints the violation with the current stack. The report itself allocates, so the hooks ignore this thread while it is written
+        void reportViolation(const char* operation)
+        {
+            if( !realtimeThread || reporting )
+            {
+                return;
+            }
+
+            reporting = true;
+            violations++;
+
+            {   //The backtrace has to be freed before the guard is lifted
+                auto backtrace = juce::SystemStats::getStackBacktrace();
+                std::fprintf(stderr, "RT sanitizer: %s on a real-time thread\n%s\n", operation, backtrace.toRawUTF8());
+            }
+
+            reporting = false;
+        }
+
+        void* allocate(size_t size)
+        {
+        #if JUCE_LINUX
+            return __libc_malloc(size);
+        #else
+            return std::malloc(size);
+        #endif
+        }
+
+        void* allocateAligned(size_t size, size_t alignment)
+        {
+        #if JUCE_LINUX
+            return __libc_memalign(alignment, size);
+        #elif JUCE_WINDOWS
+            return _aligned_malloc(size, alignment);
+        #else
+            void* memory = nullptr;
+            return posix_memalign(&memory, juce::jmax(alignment, sizeof(void*)), size) == 0 ? memory : nullptr;
+        #endif
+        }
+
+        void deallocate(void* memory)
+        {
+        #if JUCE_LINUX
+            __libc_free(memory);
+        #else
+            std::free(memory);
+        #endif
+        }
+
+        void deallocateAligned(void* memory)
+        {
+        #if JUCE_WINDOWS
+            _aligned_free(memory);
+        #else
+            deallocate(memory);
+        #endif
+        }
+
+        void* checkedNew(size_t size)
+        {
+            reportViolation("operator new");
+            if( auto* memory = allocate(size == 0 ? 1 : size) )
+            {
+                return memory;
+            }
+            throw std::bad_alloc();
+        }
+
+        void* checkedNewAligned(size_t size, std::align_val_t alignment)
+        {
+            reportViolation("operator new");
+            if( auto* memory = allocateAligned(size == 0 ? 1 : size, (size_t)alignment) )
+            {
+                return memory;
+            }
+            throw std::bad_alloc();
+        }
+
+        void checkedDelete(void* memory)
+        {
+            if( memory != nullptr )
+            {
+                reportViolation("operator delete");
+                deallocate(memory);
+            }
+        }
+
+        void checkedDeleteAligned(void* memory)
+        {
+            if( memory != nullptr )
+            {
+                reportViolation("operator delete");
+                deallocateAligned(memory);
+            }
+        }
+    }
+
+    ScopedRealtimeCheck::ScopedRealtimeCheck() : wasRealtime(realtimeThread)
+    {
+        realtimeThread = true;
+    }
+
+    ScopedRealtimeCheck::~ScopedRealtimeCheck()
+    {
+        realtimeThread = wasRealtime;
+    }
+
+    int ScopedRealtimeCheck::getNumViolations()
+    {
+        return violations.load();
+    }
+
+    RealtimeLockAllowance::RealtimeLockAllowance(const juce::CriticalSection& lock, const char* reason)
+    {
+    #if JUCE_LINUX
+        //The section's mutex is private, so it is taken once to see which one reaches the hook
+        probingLock = true;
+        probedMutex = nullptr;
+        lock.enter();
+        lock.exit();
+        probingLock = false;
+        jassert(probedMutex != nullptr);
+
+        for(int i = 0; i < MAX_ALLOWED_LOCKS; i++)
+        {
+            const void* expected = nullptr;
+            if( allowedLocks[(size_t)i].compare_exchange_strong(expected, probedMutex) )
+            {
+                index = i;
+                std::fprintf(stderr, "RT sanitizer: allowing lock %p, %s\n", probedMutex, reason);
+                return;
+            }
+        }
+
+        std::fprintf(stderr, "RT sanitizer: too many allowed locks, %p will be reported\n", probedMutex);
+    #else
+        juce::ignoreUnused(lock, reason);
+    #endif
+    }
+
+    RealtimeLockAllowance::~RealtimeLockAllowance()
+    {
+        if( index >= 0 )
+        {
+            allowedLocks[(size_t)index].store(nullptr);
+        }
+    }
+}
+
+//==============================================================================
+void* operator new(size_t size) { return Utils::checkedNew(size); }
+void* operator new[](size_t size) { return Utils::checkedNew(size); }
+void* operator new(size_t size, std::align_val_t alignment) { return Utils::checkedNewAligned(size, alignment); }
+void* operator new[](size_t size, std::align_val_t alignment) { return Utils::checkedNewAligned(size, alignment); }
+
+void operator delete(void* memory) noexcept { Utils::checkedDelete(memory); }
+void operator delete[](void* memory) noexcept { Utils::checkedDelete(memory); }
+void operator delete(void* memory, size_t) noexcept { Utils::checkedDelete(memory); }
+void operator delete[](void* memory, size_t) noexcept { Utils::checkedDelete(memory); }
+void operator delete(void* memory, std::align_val_t) noexcept { Utils::checkedDeleteAligned(memory); }
+void operator delete[](void* memory, std::align_val_t) noexcept { Utils::checkedDeleteAligned(memory); }
+void operator delete(void* memory, size_t, std::align_val_t) noexcept { Utils::checkedDeleteAligned(memory); }
+void operator delete[](void* memory, size_t, std::align_val_t) noexcept { Utils::checkedDeleteAligned(memory); }
+
+#if JUCE_LINUX
+extern "C"
+{
+    void* malloc(size_t size)
+    {
+        Utils::reportViolation("malloc");
+        return __libc_malloc(size);
+    }
+
+    void* calloc(size_t count, size_t size)
+    {
+        Utils::reportViolation("calloc");
+        return __libc_calloc(count, size);
+    }
+
+    void* realloc(void* memory, size_t size)
+    {
+        Utils::reportViolation("realloc");
+        return __libc_realloc(memory, size);
+    }
+
+    void free(void* memory)
+    {
+        if( memory != nullptr )
+        {
+            Utils::reportViolation("free");
+        }
+        __libc_free(memory);
+    }
+
+    /// Even an uncontended lock is reported, a lock the audio thread shares with any other thread can block it
+    int pthread_mutex_lock(pthread_mutex_t* mutex)
+    {
+        if( Utils::probingLock )
+        {
+            Utils::probedMutex = mutex;
+        }
+        else if( !Utils::isAllowedLock(mutex) )
+        {
+            Utils::reportViolation("lock");
+        }
+
+        auto lock = Utils::nextMutexLock.load(std::memory_order_relaxed);
+        if( lock == nullptr )
+        {
+            lock = (Utils::LockFunction)dlsym(RTLD_NEXT, "pthread_mutex_lock");
+            Utils::nextMutexLock.store(lock, std::memory_order_relaxed);
+        }
+        return lock(mutex);
+    }
+}
+#endif
+
+#endif
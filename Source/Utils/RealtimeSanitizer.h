@@ -0,0 +1,49 @@
+#pragma once
+#include <JuceHeader.h>
+
+//Set to 1 to build with the real-time sanitizer, the Debug-RTSan configuration does. Every allocation, free and lock on a thread inside a ScopedRealtimeCheck is then reported to stderr with a stack trace, except for the locks allowed by a RealtimeLockAllowance.
+//operator new/delete are hooked on every platform, malloc and pthread mutexes only on Linux, where the executable's definitions take precedence (use the standalone build there)
+#ifndef VST_SYNTH_RT_SANITIZER
+ #define VST_SYNTH_RT_SANITIZER 0
+#endif
+
+namespace Utils
+{
+    /// @brief Marks the current thread as real-time for the lifetime of the object. Does nothing unless the sanitizer is built in
+    struct ScopedRealtimeCheck
+    {
+    #if VST_SYNTH_RT_SANITIZER
+        ScopedRealtimeCheck();
+        ~ScopedRealtimeCheck();
+
+        /// @return The number of violations reported since the start of the process
+        static int getNumViolations();
+
+    private:
+        bool wasRealtime;
+    #else
+        ScopedRealtimeCheck() {}
+        static int getNumViolations() { return 0; }
+    #endif
+
+        JUCE_DECLARE_NON_COPYABLE(ScopedRealtimeCheck)
+    };
+
+    /// @brief Lets real-time threads take the given lock without a report while the object exists. This is the sanitizer's whole allow-list, every entry states its reason.
+    /// Only for locks that juce takes on the audio thread and no other thread takes while audio is running, so they are never contended
+    struct RealtimeLockAllowance
+    {
+    #if VST_SYNTH_RT_SANITIZER
+        /// @param reason Why the lock can't block the audio thread, printed when the allowance is made
+        RealtimeLockAllowance(const juce::CriticalSection& lock, const char* reason);
+        ~RealtimeLockAllowance();
+
+    private:
+        int index = -1;                                     //The allowance's entry in the list, -1 if the list was full
+    #else
+        RealtimeLockAllowance(const juce::CriticalSection&, const char*) {}
+    #endif
+
+        JUCE_DECLARE_NON_COPYABLE(RealtimeLockAllowance)
+    };
+}
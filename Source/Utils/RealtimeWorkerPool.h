@@ -0,0 +1,155 @@
+#pragma once
+#include <JuceHeader.h>
+#include "WorkerThread.h"
+#include "RealtimeSanitizer.h"
+
+#if JUCE_INTEL
+ #include <immintrin.h>
+#endif
+
+namespace Utils
+{
+    /// @brief Tells the core that the thread is spinning, so it saves power and lets a sibling hyper-thread run
+    inline void pauseWhileSpinning() noexcept
+    {
+       #if JUCE_INTEL
+        _mm_pause();
+       #elif JUCE_ARM && ( defined(__GNUC__) || defined(__clang__) )
+        __asm__ __volatile__ ("yield");
+       #elif JUCE_ARM && defined(_MSC_VER)
+        __yield();
+       #endif
+    }
+
+    /// @brief A fixed set of pre-spawned real-time threads that help the calling thread through a batch of tasks.
+    /// Idle participants take the next unclaimed task from a shared counter, so a slow task never holds up the rest of the batch.
+    /// Dispatching a batch never locks or allocates, the workers sleep on an atomic between batches
+    class RealtimeWorkerPool
+    {
+    public:
+        static constexpr int MAX_TASKS = 0xffff;            //The task count and the next task share 16 bits each of the cursor
+        static constexpr int SPINS_BEFORE_YIELD = 1024;     //Roughly 10 to 50 microseconds of pauses, after that a worker that hasn't finished was most likely preempted
+
+        /// @param numWorkers The number of threads to spawn, besides the thread that calls run
+        /// @param job The function that performs one task, called with the index of the task
+        RealtimeWorkerPool(int numWorkers, std::function<void(int)> job) :
+            job(std::move(job))
+        {
+            for(int i = 0; i < numWorkers; i++)
+            {
+                auto* worker = workers.add(std::make_unique<WorkerThread>([this] { workerLoop(); }));
+                worker->startRealtimeThread(juce::Thread::RealtimeOptions{});
+            }
+        }
+
+        ~RealtimeWorkerPool()
+        {
+            exiting.store(true, std::memory_order_relaxed);
+            generation.fetch_add(1, std::memory_order_release);
+            generation.notify_all();
+
+            for(auto* worker : workers)
+            {
+                worker->stopThread(1000);
+            }
+        }
+
+        /// @brief Performs tasks [0, numTasks) on the workers and the calling thread, and returns once all of them are finished
+        /// @param numTasks At most MAX_TASKS
+        void run(int numTasks)
+        {
+            jassert(juce::isPositiveAndNotGreaterThan(numTasks, MAX_TASKS));
+
+            const auto batch = generation.load(std::memory_order_relaxed) + 1;
+
+            remaining.store(numTasks, std::memory_order_relaxed);
+            cursor.store(makeCursor(batch, numTasks, 0), std::memory_order_release);
+
+            generation.store(batch, std::memory_order_release);
+            generation.notify_all();
+
+            //Returns once every task is claimed, so whatever the workers didn't get to in time has already run here
+            runTasks(batch);
+            waitForClaimedTasks();
+        }
+
+        /// @return The number of threads that work on a batch, including the caller
+        int getNumParticipants() const { return workers.size() + 1; }
+
+    private:
+        juce::OwnedArray<WorkerThread> workers;
+        std::function<void(int)> job;
+
+        std::atomic<uint32_t> generation { 0 };
+        std::atomic<uint64_t> cursor { 0 };                 //The batch in the upper 32 bits, then the batch's task count and the next unclaimed task in 16 bits each
+        std::atomic<int> remaining { 0 };
+        std::atomic<bool> exiting { false };
+
+        void workerLoop()
+        {
+            auto seenGeneration = generation.load(std::memory_order_acquire);
+
+            while(true)
+            {
+                generation.wait(seenGeneration, std::memory_order_acquire);
+                seenGeneration = generation.load(std::memory_order_acquire);
+
+                if(exiting.load(std::memory_order_relaxed))
+                {
+                    return;
+                }
+
+                ScopedRealtimeCheck realtimeCheck;
+                runTasks(seenGeneration);
+            }
+        }
+
+        /// @brief Waits for the tasks that the workers are still performing. The caller is expected to be the audio thread, so it spins instead of sleeping.
+        /// If the tasks take long, their worker was probably preempted, and the caller gives up its time slice between checks so it doesn't compete with it
+        void waitForClaimedTasks() const noexcept
+        {
+            for(int spins = 0; remaining.load(std::memory_order_acquire) > 0; spins++)
+            {
+                if(spins < SPINS_BEFORE_YIELD)
+                {
+                    pauseWhileSpinning();
+                }
+                else
+                {
+                    juce::Thread::yield();
+                }
+            }
+        }
+
+        static uint64_t makeCursor(uint32_t batch, int numTasks, int nextTask)
+        {
+            return ( (uint64_t)batch << 32 ) | ( (uint64_t)numTasks << 16 ) | (uint64_t)nextTask;
+        }
+
+        /// @brief Claims and performs tasks of the given batch until none are left. The batch and its task count are read from the same word as the task that is claimed,
+        /// so a worker that wakes up late can neither claim tasks of a newer batch nor compare against a newer batch's count
+        void runTasks(uint32_t batch)
+        {
+            auto current = cursor.load(std::memory_order_acquire);
+
+            while((uint32_t)(current >> 32) == batch)
+            {
+                const int numTasks = (int)( ( current >> 16 ) & 0xffff );
+                const int task = (int)( current & 0xffff );
+                if(task >= numTasks)
+                {
+                    return;
+                }
+
+                if(cursor.compare_exchange_weak(current, current + 1, std::memory_order_acq_rel, std::memory_order_acquire))
+                {
+                    job(task);
+                    remaining.fetch_sub(1, std::memory_order_release);
+                    current = cursor.load(std::memory_order_acquire);
+                }
+            }
+        }
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RealtimeWorkerPool)
+    };
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "../../PluginProcessor.h"
+#include "../EditorParameters.h"
+
+namespace Editor::Synthesizer
+{
+    class PartialEnvelopeComponent : public juce::Component
+    {
+    public:
+        PartialEnvelopeComponent(VST_SynthAudioProcessor& p) : audioProcessor(p)
+        {
+            engineToggle = std::make_unique<juce::ToggleButton>( "Partial Envelopes" );
+            engineToggleAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(
+                audioProcessor.apvts,
+                "partialEngine",
+                *engineToggle);
+            addAndMakeVisible(*engineToggle);
+
+            decayKnob = std::make_unique<juce::Slider>(
+                juce::Slider::SliderStyle::RotaryHorizontalVerticalDrag,
+                juce::Slider::TextEntryBoxPosition::TextBoxBelow);
+            decayKnobAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
+                audioProcessor.apvts,
+                "partialDecay",
+                *decayKnob);
+            decayKnob->setScrollWheelEnabled(false);
+            decayKnob->setTextValueSuffix(" ms");
+            decayKnob->setTextBoxIsEditable(true);
+            addAndMakeVisible(*decayKnob);
+
+            decayLabel = std::make_unique<juce::Label>();
+            decayLabel->setText("Partial Decay", juce::NotificationType::dontSendNotification);
+            decayLabel->setJustificationType(juce::Justification::centred);
+            addAndMakeVisible(*decayLabel);
+
+            tiltKnob = std::make_unique<juce::Slider>(
+                juce::Slider::SliderStyle::RotaryHorizontalVerticalDrag,
+                juce::Slider::TextEntryBoxPosition::TextBoxBelow);
+            tiltKnobAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
+                audioProcessor.apvts,
+                "partialDecayTilt",
+                *tiltKnob);
+            tiltKnob->setScrollWheelEnabled(false);
+            tiltKnob->setTextValueSuffix("%");
+            tiltKnob->setTextBoxIsEditable(true);
+            addAndMakeVisible(*tiltKnob);
+
+            tiltLabel = std::make_unique<juce::Label>();
+            tiltLabel->setText("Decay Tilt", juce::NotificationType::dontSendNotification);
+            tiltLabel->setJustificationType(juce::Justification::centred);
+            addAndMakeVisible(*tiltLabel);
+
+            sustainKnob = std::make_unique<juce::Slider>(
+                juce::Slider::SliderStyle::RotaryHorizontalVerticalDrag,
+                juce::Slider::TextEntryBoxPosition::TextBoxBelow);
+            sustainKnobAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
+                audioProcessor.apvts,
+                "partialSustain",
+                *sustainKnob);
+            sustainKnob->setScrollWheelEnabled(false);
+            sustainKnob->setTextValueSuffix("%");
+            sustainKnob->setTextBoxIsEditable(true);
+            addAndMakeVisible(*sustainKnob);
+
+            sustainLabel = std::make_unique<juce::Label>();
+            sustainLabel->setText("Partial Sustain", juce::NotificationType::dontSendNotification);
+            sustainLabel->setJustificationType(juce::Justification::centred);
+            addAndMakeVisible(*sustainLabel);
+        }
+
+        ~PartialEnvelopeComponent() override {}
+
+        void paint(juce::Graphics& g) override {}
+
+        void resized() override
+        {
+            using TrackInfo = juce::Grid::TrackInfo;
+            using Fr = juce::Grid::Fr;
+            using Px = juce::Grid::Px;
+
+            juce::Grid grid;
+            grid.templateRows = { TrackInfo( Fr( 1 ) ), TrackInfo( Px( LABEL_HEIGHT ) ) };
+            grid.templateColumns = { TrackInfo( Fr( 1 ) ), TrackInfo( Fr( 1 ) ), TrackInfo( Fr( 1 ) ), TrackInfo( Fr( 1 ) ) };
+            grid.items = {
+                juce::GridItem( *engineToggle ).withColumn( { 1 } ).withRow( { 1, 3 } ),
+                juce::GridItem( *decayKnob ).withColumn( { 2 } ).withRow( { 1 } ),
+                juce::GridItem( *decayLabel ).withColumn( { 2 } ).withRow( { 2 } ),
+                juce::GridItem( *tiltKnob ).withColumn( { 3 } ).withRow( { 1 } ),
+                juce::GridItem( *tiltLabel ).withColumn( { 3 } ).withRow( { 2 } ),
+                juce::GridItem( *sustainKnob ).withColumn( { 4 } ).withRow( { 1 } ),
+                juce::GridItem( *sustainLabel ).withColumn( { 4 } ).withRow( { 2 } ) };
+
+            grid.setGap( Px( PADDING_PX ) );
+            auto bounds = getLocalBounds();
+            bounds.reduce(PADDING_PX, PADDING_PX);
+            grid.performLayout(bounds);
+        }
+
+    private:
+        VST_SynthAudioProcessor& audioProcessor;
+
+        std::unique_ptr<juce::ToggleButton> engineToggle;
+        std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> engineToggleAttachment;
+
+        std::unique_ptr<juce::Slider> decayKnob, tiltKnob, sustainKnob;
+        std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> decayKnobAttachment, tiltKnobAttachment, sustainKnobAttachment;
+
+        std::unique_ptr<juce::Label> decayLabel, tiltLabel, sustainLabel;
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PartialEnvelopeComponent)
+    };
+}
@@ -19,6 +19,7 @@
 #include "PhaseComponent.h"
 #include "UnisonComponent.h"
 #include "ADSRComponent.h"
+#include "PartialEnvelopeComponent.h"
 #include "Gain/SynthGainComponent.h"
 
 namespace Editor::Synthesizer
@@ -31,6 +32,7 @@ namespace Editor::Synthesizer
             addAndMakeVisible(*waveformSelector);
             addAndMakeVisible(*unisonComponent);
             addAndMakeVisible(*adsrComponent);
+            addAndMakeVisible(*partialEnvelopeComponent);
             addAndMakeVisible(*phaseComponent);
             addAndMakeVisible(*tuningComponent);
             addAndMakeVisible(*synthGainComponent);
@@ -56,7 +58,7 @@ namespace Editor::Synthesizer
             using Px = juce::Grid::Px;
 
             juce::Grid grid;
-            grid.templateRows = { TrackInfo( Fr( 1 ) ), TrackInfo( Fr( 1 ) ), TrackInfo( Fr( 1 ) ) };
+            grid.templateRows = { TrackInfo( Fr( 3 ) ), TrackInfo( Fr( 3 ) ), TrackInfo( Fr( 3 ) ), TrackInfo( Fr( 2 ) ) };
             grid.templateColumns = { TrackInfo( Fr( 1 ) ), TrackInfo( Fr( 1 ) ) };
             grid.items = {
                 juce::GridItem( *waveformSelector ).withColumn( { 1 } ).withRow( { 1 } ),
@@ -64,7 +66,8 @@ namespace Editor::Synthesizer
                 juce::GridItem( *adsrComponent ).withColumn( { 1 } ).withRow( { 3 } ),
                 juce::GridItem( *phaseComponent ).withColumn( { 2 } ).withRow( { 1 } ),
                 juce::GridItem( *tuningComponent ).withColumn( { 2 } ).withRow( { 2 } ),
-                juce::GridItem( *synthGainComponent ).withColumn( { 2 } ).withRow( { 3 } ) };
+                juce::GridItem( *synthGainComponent ).withColumn( { 2 } ).withRow( { 3 } ),
+                juce::GridItem( *partialEnvelopeComponent ).withColumn( { 1, 3 } ).withRow( { 4 } ) };
 
             grid.setGap( Px( PADDING_PX ) );
             auto bounds = getLocalBounds();
@@ -81,6 +84,7 @@ namespace Editor::Synthesizer
         std::unique_ptr<UnisonComponent> unisonComponent = std::make_unique<UnisonComponent>(audioProcessor);
         std::unique_ptr<SynthGainComponent> synthGainComponent = std::make_unique<SynthGainComponent>(audioProcessor);
         std::unique_ptr<ADSRComponent> adsrComponent = std::make_unique<ADSRComponent>(audioProcessor);
+        std::unique_ptr<PartialEnvelopeComponent> partialEnvelopeComponent = std::make_unique<PartialEnvelopeComponent>(audioProcessor);
 
         JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SynthesizerTab)
     };
@@ -108,23 +108,15 @@ namespace Editor::Synthesizer
 
             using namespace Processor::Synthesizer;
 
-            for(int i = 0; i < HARMONIC_N; i++)
+            std::array<float, HARMONIC_N> gains {};
+            std::array<float, HARMONIC_N> phases {};
+            for(int i = 0; i < juce::jmin(dataset.size(), HARMONIC_N); i++)
             {
-                audioProcessor.apvts.getParameter(OscillatorParameters::getPartialGainParameterID(i))->beginChangeGesture();
-                audioProcessor.apvts.getParameter(OscillatorParameters::getPartialPhaseParameterID(i))->beginChangeGesture();
-                if( i >= dataset.size() )
-                {
-                    audioProcessor.apvts.getParameter(OscillatorParameters::getPartialGainParameterID(i))->setValueNotifyingHost(0.f);
-                    audioProcessor.apvts.getParameter(OscillatorParameters::getPartialPhaseParameterID(i))->setValueNotifyingHost(0.f);
-                }
-                else
-                {
-                    audioProcessor.apvts.getParameter(OscillatorParameters::getPartialGainParameterID(i))->setValueNotifyingHost(dataset[i].gain);
-                    audioProcessor.apvts.getParameter(OscillatorParameters::getPartialPhaseParameterID(i))->setValueNotifyingHost(dataset[i].phase);
-                }
-                audioProcessor.apvts.getParameter(OscillatorParameters::getPartialGainParameterID(i))->endChangeGesture();
-                audioProcessor.apvts.getParameter(OscillatorParameters::getPartialPhaseParameterID(i))->endChangeGesture();
+                gains[i] = dataset[i].gain;
+                phases[i] = dataset[i].phase;
             }
+
+            audioProcessor.additiveSynth.getOscParameters().applyPartialSpectrum(gains, phases);
         }
 
         /// @brief Creates a state for a given waveform
@@ -0,0 +1,196 @@
+#include <JuceHeader.h>
+#include "../../Source/Model/Effects/Equalizer/BiquadKernel.h"
+
+namespace Processor::Effects::Equalizer
+{
+    class BiquadCascadeTests : public juce::UnitTest
+    {
+    public:
+        BiquadCascadeTests() : juce::UnitTest("BiquadCascade", "VST_Synth") {}
+
+        void runTest() override
+        {
+            beginTest("Every band matches juce's peak filter on both channels");
+            for(int band = 0; band < BANDS; band++)
+            {
+                BiquadCascade<BANDS> cascade;
+                cascade.setSection(band, BiquadCoefficients::makePeak(SAMPLE_RATE, getFrequency(band), Q, getGainFactor(band)));
+
+                Reference reference;
+                reference.addBand(band);
+
+                expectLessThan(processBoth(cascade, reference), TOLERANCE, "Band " + juce::String(band));
+            }
+
+            beginTest("The whole cascade matches the filters in series");
+            {
+                BiquadCascade<BANDS> cascade;
+                Reference reference;
+                for(int band = 0; band < BANDS; band++)
+                {
+                    cascade.setSection(band, BiquadCoefficients::makePeak(SAMPLE_RATE, getFrequency(band), Q, getGainFactor(band)));
+                    reference.addBand(band);
+                }
+
+                expectLessThan(processBoth(cascade, reference), TOLERANCE);
+                expectLessThan(processBoth(cascade, reference), TOLERANCE, "The state carries over to the next block");
+            }
+
+            beginTest("Blocks shorter than the cascade and blocks of any length give the same result");
+            {
+                BiquadCascade<BANDS> cascade;
+                Reference reference;
+                for(int band = 0; band < BANDS; band++)
+                {
+                    cascade.setSection(band, BiquadCoefficients::makePeak(SAMPLE_RATE, getFrequency(band), Q, getGainFactor(band)));
+                    reference.addBand(band);
+                }
+
+                auto samples = makeNoise(2);
+                auto expected = samples;
+                for(int i = 0; i < 2 * NUM_SAMPLES; i++)
+                    expected[(size_t)i] = reference.processSample(i / NUM_SAMPLES, expected[(size_t)i]);
+
+                int start = 0;
+                for(int blockSize = 1; start < NUM_SAMPLES; blockSize = blockSize * 3 % 131)
+                {
+                    const int numSamples = juce::jmin(blockSize, NUM_SAMPLES - start);
+                    cascade.process(samples.data() + start, samples.data() + NUM_SAMPLES + start, numSamples);
+                    start += numSamples;
+                }
+
+                expectLessThan(getLargestError(samples, expected), TOLERANCE);
+            }
+
+            beginTest("A mono signal only uses the first lane");
+            {
+                BiquadCascade<BANDS> cascade;
+                Reference reference;
+                for(int band : { 1, 4, 8 })
+                {
+                    cascade.setSection(band, BiquadCoefficients::makePeak(SAMPLE_RATE, getFrequency(band), Q, getGainFactor(band)));
+                    reference.addBand(band);
+                }
+
+                auto samples = makeNoise(1);
+                auto expected = samples;
+                for(auto& sample : expected)
+                    sample = reference.processSample(0, sample);
+
+                cascade.process(samples.data(), nullptr, NUM_SAMPLES);
+                expectLessThan(getLargestError(samples, expected), TOLERANCE);
+            }
+
+            beginTest("Bands at 0 dB are skipped");
+            {
+                BiquadCascade<BANDS> cascade;
+                expect(cascade.isBypassed());
+
+                Reference reference;
+                for(int band = 0; band < BANDS; band++)
+                {
+                    cascade.setSection(band, BiquadCoefficients::makePeak(SAMPLE_RATE, getFrequency(band), Q, getGainFactor(band)));
+                    if( band % 3 == 0 )
+                        cascade.disableSection(band);
+                    else
+                        reference.addBand(band);
+                }
+
+                expect(!cascade.isBypassed());
+                expectLessThan(processBoth(cascade, reference), TOLERANCE);
+
+                for(int band = 0; band < BANDS; band++)
+                    cascade.disableSection(band);
+                expect(cascade.isBypassed());
+
+                auto samples = makeNoise(2);
+                const auto untouched = samples;
+                cascade.process(samples.data(), samples.data() + NUM_SAMPLES, NUM_SAMPLES);
+                expect(samples == untouched, "A bypassed cascade leaves the signal alone");
+            }
+
+            beginTest("A band that was off starts from silence when it is switched on");
+            {
+                BiquadCascade<BANDS> cascade;
+                const auto coefficients = BiquadCoefficients::makePeak(SAMPLE_RATE, getFrequency(5), Q, getGainFactor(5));
+                cascade.setSection(5, coefficients);
+
+                auto samples = makeNoise(3);
+                cascade.process(samples.data(), samples.data() + NUM_SAMPLES, NUM_SAMPLES);
+
+                cascade.disableSection(5);
+                cascade.setSection(5, coefficients);
+
+                Reference reference;
+                reference.addBand(5);
+                expectLessThan(processBoth(cascade, reference), TOLERANCE);
+            }
+        }
+
+    private:
+        static constexpr int BANDS = 10;
+        static constexpr int NUM_SAMPLES = 2048;
+        static constexpr double SAMPLE_RATE = 48000.0;
+        static constexpr float Q = 1.5f;
+        static constexpr float TOLERANCE = 1.0e-5f;         //Both run in double precision, only the rounding of the float samples differs
+
+        /// @brief The equalizer's band frequencies, with gains alternating between 6 dB and -6 dB
+        static float getFrequency(int band) { return 31.25f * (float)( 1 << band ); }
+        static float getGainFactor(int band) { return juce::Decibels::decibelsToGain(band % 2 == 0 ? 6.f : -6.f); }
+
+        /// @brief One juce peak filter per band and channel, run in series like the equalizer did before the cascade. In double precision, single precision filters drift at the lowest band
+        struct Reference
+        {
+            std::array<std::vector<juce::dsp::IIR::Filter<double>>, 2> channels;
+
+            void addBand(int band)
+            {
+                for(auto& filters : channels)
+                {
+                    filters.emplace_back();
+                    filters.back().coefficients = juce::dsp::IIR::Coefficients<double>::makePeakFilter(SAMPLE_RATE, getFrequency(band), Q, getGainFactor(band));
+                }
+            }
+
+            float processSample(int channel, float sample)
+            {
+                double value = sample;
+                for(auto& filter : channels[(size_t)channel])
+                    value = filter.processSample(value);
+                return (float)value;
+            }
+        };
+
+        /// @return A block of noise with the given number of channels, one after the other
+        std::vector<float> makeNoise(int numChannels)
+        {
+            auto random = getRandom();
+            std::vector<float> samples((size_t)( numChannels * NUM_SAMPLES ));
+            for(auto& sample : samples)
+                sample = random.nextFloat() * 2.f - 1.f;
+            return samples;
+        }
+
+        static float getLargestError(const std::vector<float>& actual, const std::vector<float>& expected)
+        {
+            float error = 0.f;
+            for(size_t i = 0; i < actual.size(); i++)
+                error = juce::jmax(error, std::abs(actual[i] - expected[i]));
+            return error;
+        }
+
+        /// @return The largest difference between the cascade and the reference over a stereo block of noise
+        float processBoth(BiquadCascade<BANDS>& cascade, Reference& reference)
+        {
+            auto samples = makeNoise(2);
+            auto expected = samples;
+            for(int i = 0; i < 2 * NUM_SAMPLES; i++)
+                expected[(size_t)i] = reference.processSample(i / NUM_SAMPLES, expected[(size_t)i]);
+
+            cascade.process(samples.data(), samples.data() + NUM_SAMPLES, NUM_SAMPLES);
+            return getLargestError(samples, expected);
+        }
+    };
+
+    static BiquadCascadeTests biquadCascadeTests;
+}
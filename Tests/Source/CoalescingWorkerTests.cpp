@@ -0,0 +1,96 @@
+#include <JuceHeader.h>
+#include "../../Source/Utils/CoalescingWorker.h"
+
+namespace Utils
+{
+    class CoalescingWorkerTests : public juce::UnitTest
+    {
+    public:
+        CoalescingWorkerTests() : juce::UnitTest("CoalescingWorker", "VST_Synth") {}
+
+        void runTest() override
+        {
+            beginTest("An idle worker stays asleep");
+            {
+                std::atomic<int> runs { 0 };
+                CoalescingWorker worker("Idle", [&runs] { runs++; });
+
+                juce::Thread::sleep(200);
+                expectEquals(runs.load(), 0);
+            }
+
+            beginTest("A request wakes the worker");
+            {
+                juce::WaitableEvent finished;
+                CoalescingWorker worker("Request", [&finished] { finished.signal(); });
+
+                worker.request();
+                expect(finished.wait(1000));
+            }
+
+            beginTest("A follow-up request wakes the worker");
+            {
+                juce::WaitableEvent finished;
+                CoalescingWorker worker("Follow-up", [&finished] { finished.signal(); });
+
+                worker.requestFollowUp();
+                expect(finished.wait(1000));
+            }
+
+            beginTest("Requests during a job make it stale and are merged into one rerun");
+            {
+                BlockingJob job;
+                CoalescingWorker worker("Coalescing", [&] { job.run(worker); });
+
+                worker.request();
+                expect(job.started.wait(1000));
+                for(int i = 0; i < 10; i++)
+                    worker.request();
+
+                job.release.signal();
+                juce::Thread::sleep(200);
+
+                expectEquals(job.runs.load(), 2);
+                expect(job.firstRunWasStale.load());
+            }
+
+            beginTest("A follow-up request during a job reruns it without making it stale");
+            {
+                BlockingJob job;
+                CoalescingWorker worker("Follow-up during a job", [&] { job.run(worker); });
+
+                worker.request();
+                expect(job.started.wait(1000));
+                worker.requestFollowUp();
+
+                job.release.signal();
+                juce::Thread::sleep(200);
+
+                expectEquals(job.runs.load(), 2);
+                expect(!job.firstRunWasStale.load());
+            }
+        }
+
+    private:
+        /// @brief A job whose first run waits until the test releases it, so requests can be made while it is running
+        struct BlockingJob
+        {
+            juce::WaitableEvent started;
+            juce::WaitableEvent release;
+            std::atomic<int> runs { 0 };
+            std::atomic<bool> firstRunWasStale { false };
+
+            void run(const CoalescingWorker& worker)
+            {
+                if( runs++ == 0 )
+                {
+                    started.signal();
+                    release.wait(1000);
+                    firstRunWasStale = worker.isStale();
+                }
+            }
+        };
+    };
+
+    static CoalescingWorkerTests coalescingWorkerTests;
+}
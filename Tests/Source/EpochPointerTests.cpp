@@ -0,0 +1,125 @@
+#include <JuceHeader.h>
+#include "../../Source/Utils/EpochPointer.h"
+
+namespace Utils
+{
+    class EpochPointerTests : public juce::UnitTest
+    {
+    public:
+        EpochPointerTests() : juce::UnitTest("EpochPointer", "VST_Synth") {}
+
+        void runTest() override
+        {
+            beginTest("Without a reader, replaced objects are dropped when they are replaced");
+            {
+                Tracker tracker;
+                EpochPointer<Tracked> pointer(tracker.make(0));
+
+                pointer.publish(tracker.make(1));
+                pointer.publish(tracker.make(2));
+
+                expectEquals(pointer.getNumRetired(), 0);
+                expectEquals(tracker.alive(), 1);
+                expectEquals(pointer.getLatest()->id, 2);
+            }
+
+            beginTest("An open scope keeps the object it entered with alive");
+            {
+                Tracker tracker;
+                EpochPointer<Tracked> pointer(tracker.make(0));
+
+                {
+                    auto scope = pointer.read();
+                    pointer.publish(tracker.make(1));
+                    pointer.publish(tracker.make(2));
+
+                    expectEquals(scope->id, 0);
+                    expect(tracker.isAlive(0));
+                    expectEquals(pointer.getNumRetired(), 2);
+                }
+
+                pointer.reclaim();
+                expectEquals(pointer.getNumRetired(), 0);
+                expectEquals(tracker.alive(), 1);
+            }
+
+            beginTest("A scope entered after a publish only holds back what was retired later");
+            {
+                Tracker tracker;
+                EpochPointer<Tracked> pointer(tracker.make(0));
+                pointer.publish(tracker.make(1));
+
+                auto scope = pointer.read();
+                expectEquals(scope->id, 1);
+
+                pointer.publish(tracker.make(2));
+                expect(!tracker.isAlive(0));
+                expect(tracker.isAlive(1));
+                expectEquals(pointer.getNumRetired(), 1);
+            }
+
+            beginTest("A reader racing the writer never sees a dropped object");
+            {
+                Tracker tracker;
+                EpochPointer<Tracked> pointer(tracker.make(0));
+                std::atomic<bool> finished { false };
+                std::atomic<int> deadReads { 0 };
+                std::atomic<int> reads { 0 };
+
+                std::thread reader([&]
+                {
+                    while( !finished.load() )
+                    {
+                        auto scope = pointer.read();
+                        if( !tracker.isAlive(scope->id) )
+                            deadReads++;
+                        reads++;
+                    }
+                });
+
+                for(int id = 1; id < Tracker::MAX_OBJECTS; id++)
+                {
+                    pointer.publish(tracker.make(id));
+                }
+                finished = true;
+                reader.join();
+
+                pointer.reclaim();
+                expectEquals(deadReads.load(), 0);
+                expectGreaterThan(reads.load(), 0);
+                expectEquals(pointer.getNumRetired(), 0);
+                expectEquals(tracker.alive(), 1);
+            }
+        }
+
+    private:
+        struct Tracker;
+
+        /// @brief Reports its own destruction, so the tests can see which objects were dropped
+        struct Tracked
+        {
+            Tracked(Tracker& tracker, int id) : tracker(tracker), id(id) { tracker.lifetimes[(size_t)id] = true; }
+            ~Tracked() { tracker.lifetimes[(size_t)id] = false; }
+
+            Tracker& tracker;
+            const int id;
+        };
+
+        struct Tracker
+        {
+            static constexpr int MAX_OBJECTS = 20000;
+
+            std::unique_ptr<Tracked> make(int id) { return std::make_unique<Tracked>(*this, id); }
+            bool isAlive(int id) const { return lifetimes[(size_t)id].load(); }
+
+            int alive() const
+            {
+                return (int)std::count_if(lifetimes.begin(), lifetimes.end(), [](const auto& lifetime) { return lifetime.load(); });
+            }
+
+            std::array<std::atomic<bool>, MAX_OBJECTS> lifetimes {};
+        };
+    };
+
+    static EpochPointerTests epochPointerTests;
+}
@@ -0,0 +1,100 @@
+#include <JuceHeader.h>
+#include "../../Source/Utils/KeyboardStateBridge.h"
+
+namespace Utils
+{
+    class KeyboardStateBridgeTests : public juce::UnitTest
+    {
+    public:
+        KeyboardStateBridgeTests() : juce::UnitTest("KeyboardStateBridge", "VST_Synth") {}
+
+        void runTest() override
+        {
+            beginTest("Without keys played on screen the host's buffer is rendered as it is");
+            {
+                juce::MidiKeyboardState state;
+                KeyboardStateBridge bridge(state);
+                bridge.prepareToPlay();
+
+                juce::MidiBuffer host;
+                host.addEvent(juce::MidiMessage::noteOn(1, 60, 1.f), 10);
+
+                expect(&bridge.processNextMidiBuffer(host) == &host);
+                expectEquals(host.getNumEvents(), 1);
+            }
+
+            beginTest("Keys played on screen start the block, followed by the host's events, and the host's buffer is left alone");
+            {
+                juce::MidiKeyboardState state;
+                KeyboardStateBridge bridge(state);
+                bridge.prepareToPlay();
+
+                juce::MidiBuffer host;
+                host.addEvent(juce::MidiMessage::noteOn(1, 60, 1.f), 10);
+                state.noteOn(1, 64, 1.f);
+
+                auto& merged = bridge.processNextMidiBuffer(host);
+                expect(&merged != &host);
+                expectEquals(host.getNumEvents(), 1);
+                expectEquals(merged.getNumEvents(), 2);
+
+                auto event = merged.begin();
+                expectEquals((*event).samplePosition, 0);
+                expectEquals((*event).getMessage().getNoteNumber(), 64);
+                ++event;
+                expectEquals((*event).samplePosition, 10);
+                expectEquals((*event).getMessage().getNoteNumber(), 60);
+
+                expect(&bridge.processNextMidiBuffer(host) == &host, "The keys are only added once");
+            }
+
+            beginTest("Merging stays within the storage reserved in prepareToPlay");
+            {
+                juce::MidiKeyboardState state;
+                KeyboardStateBridge bridge(state);
+                bridge.prepareToPlay();
+
+                juce::MidiBuffer host;
+                state.noteOn(1, 64, 1.f);
+                const auto* storage = bridge.processNextMidiBuffer(host).data.begin();
+
+                //As many short messages as the host may send next to a full queue of keys
+                const int hostEvents = ( MERGED_MIDI_RESERVE_BYTES - KEYBOARD_QUEUE_SIZE * ( MIDI_EVENT_OVERHEAD_BYTES + 3 ) ) / ( MIDI_EVENT_OVERHEAD_BYTES + 3 );
+                for(int i = 0; i < hostEvents; i++)
+                    host.addEvent(juce::MidiMessage::noteOn(1, i % 128, 1.f), i);
+
+                //The fifo keeps one slot free, so a full queue holds one message less than its size
+                for(int i = 0; i < KEYBOARD_QUEUE_SIZE - 1; i++)
+                {
+                    if( i % 2 == 0 )
+                        state.noteOn(2, ( i / 2 ) % 128, 1.f);
+                    else
+                        state.noteOff(2, ( i / 2 ) % 128, 0.f);
+                }
+
+                auto& merged = bridge.processNextMidiBuffer(host);
+                expectEquals(merged.getNumEvents(), hostEvents + KEYBOARD_QUEUE_SIZE - 1);
+                expect(merged.data.begin() == storage, "The merged buffer was reallocated");
+            }
+
+            beginTest("Keys wait for the next block when the host's events would not fit next to them");
+            {
+                juce::MidiKeyboardState state;
+                KeyboardStateBridge bridge(state);
+                bridge.prepareToPlay();
+
+                juce::MidiBuffer host;
+                for(int i = 0; host.data.size() <= MERGED_MIDI_RESERVE_BYTES; i++)
+                    host.addEvent(juce::MidiMessage::controllerEvent(1, 1, i % 128), i);
+
+                state.noteOn(1, 64, 1.f);
+                expect(&bridge.processNextMidiBuffer(host) == &host);
+
+                host.clear();
+                expectEquals(bridge.processNextMidiBuffer(host).getNumEvents(), 1);
+            }
+        }
+    };
+
+    static KeyboardStateBridgeTests keyboardStateBridgeTests;
+}
@@ -0,0 +1,24 @@
+#include <JuceHeader.h>
+
+//Runs every unit test of the plugin's sources. The exit code is the number of failed checks, so the runner can gate a build
+int main(int argc, char* argv[])
+{
+    juce::UnitTestRunner runner;
+    runner.setAssertOnFailure(false);
+
+    if( argc > 1 )
+    {
+        runner.runTestsInCategory(argv[1]);
+    }
+    else
+    {
+        runner.runTestsInCategory("VST_Synth");
+    }
+
+    int failures = 0;
+    for(int i = 0; i < runner.getNumResults(); i++)
+    {
+        failures += runner.getResult(i)->failures;
+    }
+    return failures;
+}
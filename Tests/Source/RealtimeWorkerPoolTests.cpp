@@ -0,0 +1,93 @@
+#include <JuceHeader.h>
+#include "../../Source/Utils/RealtimeWorkerPool.h"
+
+namespace Utils
+{
+    class RealtimeWorkerPoolTests : public juce::UnitTest
+    {
+    public:
+        RealtimeWorkerPoolTests() : juce::UnitTest("RealtimeWorkerPool", "VST_Synth") {}
+
+        void runTest() override
+        {
+            constexpr int maxTasks = 64;
+            std::array<std::atomic<int>, maxTasks> runs;
+            RealtimeWorkerPool pool(3, [&runs](int task) { runs[(size_t)task].fetch_add(1, std::memory_order_relaxed); });
+
+            auto runBatch = [&](int numTasks)
+            {
+                for(auto& count : runs)
+                    count.store(0, std::memory_order_relaxed);
+
+                pool.run(numTasks);
+
+                for(int task = 0; task < maxTasks; task++)
+                {
+                    if( runs[(size_t)task].load(std::memory_order_relaxed) != ( task < numTasks ? 1 : 0 ) )
+                        return false;
+                }
+                return true;
+            };
+
+            beginTest("Every task of a batch runs exactly once");
+            for(int numTasks = 0; numTasks <= maxTasks; numTasks++)
+            {
+                expect(runBatch(numTasks), "Batch of " + juce::String(numTasks) + " tasks");
+            }
+
+            beginTest("Batches of different sizes back to back");
+            {   //Small batches right after large ones give late workers the chance to claim with a stale count
+                juce::Random random(0x5eed);
+                int failedBatches = 0;
+
+                for(int batch = 0; batch < 50000; batch++)
+                {
+                    const int numTasks = batch % 2 == 0 ? 1 + random.nextInt(3) : maxTasks / 2 + random.nextInt(maxTasks / 2 + 1);
+                    if( !runBatch(numTasks) )
+                        failedBatches++;
+                }
+                expectEquals(failedBatches, 0);
+            }
+
+            beginTest("A batch finishes while a worker is stalled in its task");
+            {   //The caller takes every task the stalled worker can't claim, then waits past the spinning phase for the one in flight
+                std::array<std::atomic<int>, maxTasks> stalledRuns;
+                const auto caller = std::this_thread::get_id();
+                std::atomic<bool> workerClaimed { false };
+
+                RealtimeWorkerPool stallingPool(1, [&](int task)
+                {
+                    if( std::this_thread::get_id() != caller )
+                    {
+                        workerClaimed = true;
+                        juce::Thread::sleep(50);
+                    }
+                    else if( task == 0 )
+                    {   //Holds the caller back until the worker is inside a task
+                        for(int waited = 0; !workerClaimed && waited < 1000; waited++)
+                            juce::Thread::sleep(1);
+                    }
+                    stalledRuns[(size_t)task].fetch_add(1, std::memory_order_relaxed);
+                });
+
+                for(auto& count : stalledRuns)
+                    count.store(0, std::memory_order_relaxed);
+
+                juce::Thread::sleep(50);                    //A worker that isn't waiting yet when the batch starts sits it out
+                const auto start = juce::Time::getMillisecondCounterHiRes();
+                stallingPool.run(maxTasks);
+                const auto elapsed = juce::Time::getMillisecondCounterHiRes() - start;
+
+                expect(workerClaimed.load());
+                expectGreaterOrEqual(elapsed, 45.0, "The caller has to wait for the stalled task");
+
+                int wrongCounts = 0;
+                for(auto& count : stalledRuns)
+                    wrongCounts += count.load(std::memory_order_relaxed) != 1 ? 1 : 0;
+                expectEquals(wrongCounts, 0);
+            }
+        }
+    };
+
+    static RealtimeWorkerPoolTests realtimeWorkerPoolTests;
+}
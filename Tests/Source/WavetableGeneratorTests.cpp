@@ -0,0 +1,131 @@
+#include <JuceHeader.h>
+#include "../../Source/Model/Synthesizer/WavetableGenerator.h"
+
+namespace Processor::Synthesizer
+{
+    class WavetableGeneratorTests : public juce::UnitTest
+    {
+    public:
+        WavetableGeneratorTests() : juce::UnitTest("WavetableGenerator", "VST_Synth") {}
+
+        void runTest() override
+        {
+            auto random = getRandom();
+
+            beginTest("A few changed partials give the same levels as regenerating them");
+            {
+                Spectrum spectrum(random);
+                WavetableGenerator incremental;
+                incremental.update(spectrum.gains, spectrum.phases, ALL_LEVELS);
+
+                for(int partial : { 0, 5, 100, HARMONIC_N - 1 })
+                {   //The first partial is held by every level, the last one only by the first
+                    spectrum.gains[(size_t)partial] = random.nextFloat();
+                    spectrum.phases[(size_t)partial] = random.nextFloat();
+                }
+                const auto gain = incremental.update(spectrum.gains, spectrum.phases, ALL_LEVELS);
+
+                WavetableGenerator regenerated;
+                const auto expectedGain = regenerated.update(spectrum.gains, spectrum.phases, ALL_LEVELS);
+
+                expectLevelsMatch(incremental, regenerated, 1.0e-4f);
+                expectWithinAbsoluteError(*gain, *expectedGain, 1.0e-3f * *expectedGain);
+            }
+
+            beginTest("Levels that were not wanted are regenerated from the updated spectrum");
+            {
+                Spectrum spectrum(random);
+                WavetableGenerator incremental;
+                incremental.update(spectrum.gains, spectrum.phases, 1u);
+
+                spectrum.gains[2] = 0.f;
+                incremental.update(spectrum.gains, spectrum.phases, 1u);
+                incremental.update(spectrum.gains, spectrum.phases, ALL_LEVELS);
+                expectEquals(incremental.getValidLevels(), ALL_LEVELS);
+
+                WavetableGenerator regenerated;
+                regenerated.update(spectrum.gains, spectrum.phases, ALL_LEVELS);
+
+                expectLevelsMatch(incremental, regenerated, 1.0e-4f);
+            }
+
+            beginTest("Rounding errors stay small over many incremental updates");
+            {
+                Spectrum spectrum(random);
+                WavetableGenerator incremental;
+                incremental.update(spectrum.gains, spectrum.phases, ALL_LEVELS);
+
+                //More edits than DELTA_RESYNC_INTERVAL, so the periodic regeneration is crossed as well
+                for(int edit = 0; edit < DELTA_RESYNC_INTERVAL + 50; edit++)
+                {
+                    const int partial = random.nextInt(16);
+                    spectrum.gains[(size_t)partial] = random.nextFloat();
+                    spectrum.phases[(size_t)partial] = random.nextFloat();
+                    incremental.update(spectrum.gains, spectrum.phases, ALL_LEVELS);
+                }
+
+                WavetableGenerator regenerated;
+                regenerated.update(spectrum.gains, spectrum.phases, ALL_LEVELS);
+
+                expectLevelsMatch(incremental, regenerated, 1.0e-3f);
+            }
+
+            beginTest("A regenerated level is the sum of its partials");
+            {
+                Spectrum spectrum(random);
+                WavetableGenerator generator;
+                generator.update(spectrum.gains, spectrum.phases, ALL_LEVELS);
+
+                for(int level : { 0, LOOKUP_SIZE / 2, LOOKUP_SIZE - 1 })
+                {
+                    const int size = WavetableGenerator::getLevelSize(level);
+                    const int harmonics = WavetableGenerator::getLevelHarmonics(level);
+
+                    float error = 0.f;
+                    for(int i = 0; i < size; i += juce::jmax(1, size / 256))
+                    {
+                        double expected = 0.0;
+                        for(int k = 0; k < harmonics; k++)
+                        {
+                            const double angle = juce::MathConstants<double>::twoPi * ( (double)( k + 1 ) * i / size + spectrum.phases[(size_t)k] );
+                            expected += spectrum.gains[(size_t)k] * std::sin(angle);
+                        }
+                        error = juce::jmax(error, std::abs(generator.getLevel(level)[i] - (float)expected));
+                    }
+                    expectLessThan(error, 1.0e-4f, "Level " + juce::String(level));
+                }
+            }
+        }
+
+    private:
+        /// @brief A sawtooth-like spectrum with random phases
+        struct Spectrum
+        {
+            explicit Spectrum(juce::Random& random)
+            {
+                for(int i = 0; i < HARMONIC_N; i++)
+                {
+                    gains[(size_t)i] = 1.f / (float)( i + 1 );
+                    phases[(size_t)i] = random.nextFloat();
+                }
+            }
+
+            std::array<float, HARMONIC_N> gains;
+            std::array<float, HARMONIC_N> phases;
+        };
+
+        void expectLevelsMatch(const WavetableGenerator& actual, const WavetableGenerator& expected, float tolerance)
+        {
+            for(int level = 0; level < LOOKUP_SIZE; level++)
+            {
+                float error = 0.f;
+                for(int i = 0; i < WavetableGenerator::getLevelSize(level); i++)
+                    error = juce::jmax(error, std::abs(actual.getLevel(level)[i] - expected.getLevel(level)[i]));
+
+                expectLessThan(error, tolerance, "Level " + juce::String(level));
+            }
+        }
+    };
+
+    static WavetableGeneratorTests wavetableGeneratorTests;
+}
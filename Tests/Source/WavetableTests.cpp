@@ -0,0 +1,71 @@
+#include <JuceHeader.h>
+#include "../../Source/Model/Synthesizer/WavetableGenerator.h"
+
+namespace Processor::Synthesizer
+{
+    class WavetableTests : public juce::UnitTest
+    {
+    public:
+        WavetableTests() : juce::UnitTest("Wavetable", "VST_Synth") {}
+
+        void runTest() override
+        {
+            beginTest("The mipmap ladder runs from every harmonic down to the fundamental");
+            {
+                expectEquals(MIPMAP_HARMONICS.front(), HARMONIC_N);
+                expectEquals(MIPMAP_HARMONICS.back(), 1);
+                for(int level = 1; level < LOOKUP_SIZE; level++)
+                    expect(MIPMAP_HARMONICS[level] < MIPMAP_HARMONICS[level - 1], "The harmonic counts have to fall with every level");
+            }
+
+            beginTest("findMipMapLevel picks the richest level that stays below Nyquist");
+            {
+                constexpr double nyquist = 24000.0;
+                for(double fundamental = 20.0; fundamental < nyquist; fundamental *= 1.01)
+                {
+                    const int level = findMipMapLevel(fundamental, nyquist);
+                    const juce::String frequency(fundamental);
+
+                    expect(level < LOOKUP_SIZE, "Only frequencies above Nyquist have no level, " + frequency);
+                    if( level == LOOKUP_SIZE )
+                        continue;
+
+                    expect(MIPMAP_HARMONICS[level] * fundamental < nyquist, "The highest harmonic aliases at " + frequency);
+                    if( level > 0 )
+                        expect(MIPMAP_HARMONICS[level - 1] * fundamental >= nyquist, "A richer level would have fit at " + frequency);
+                }
+            }
+
+            beginTest("findMipMapLevel handles the edges of the range");
+            {
+                expectEquals(findMipMapLevel(0.0, 24000.0), 0);
+                expectEquals(findMipMapLevel(1.0, 24000.0), 0);
+                expectEquals(findMipMapLevel(24000.0, 24000.0), LOOKUP_SIZE);
+                expectEquals(findMipMapLevel(30000.0, 24000.0), LOOKUP_SIZE);
+                expectEquals(findMipMapLevel(23999.0, 24000.0), LOOKUP_SIZE - 1);
+            }
+
+            beginTest("Every level is a power of two with more than half of POINTS_PER_HARMONIC for each harmonic");
+            {
+                int totalPoints = 0;
+                for(int level = 0; level < LOOKUP_SIZE; level++)
+                {
+                    const int size = WavetableGenerator::getLevelSize(level);
+                    const int harmonics = MIPMAP_HARMONICS[level];
+
+                    expect(juce::isPowerOfTwo(size));
+                    expectLessOrEqual(size, harmonics * POINTS_PER_HARMONIC);
+                    expectGreaterThan(size, harmonics * POINTS_PER_HARMONIC / 2);
+                    expectGreaterOrEqual(size / 2 - 1, harmonics, "Every harmonic of the level has to fit below the table's Nyquist");
+
+                    totalPoints += size + 1;
+                }
+
+                //The octave levels alone would take 2 * LOOKUP_POINTS, the two steps between them add less than the octave above each
+                expectLessThan(totalPoints, 4 * LOOKUP_POINTS);
+            }
+        }
+    };
+
+    static WavetableTests wavetableTests;
+}